@@ -0,0 +1,225 @@
+#ifndef __CONCURRENT_SORTED_LIST_HPP
+#define __CONCURRENT_SORTED_LIST_HPP
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <utility>
+#include "SortedList.hpp"
+
+// A SortedList that can be shared between threads. Every call takes a reader-writer lock:
+// calls that only look at the list (contains, tryGet, getIndex, ...) share it, so any number of
+// them run at once, and calls that change the list (insert, remove, ...) hold it on their own.
+//
+// Nothing that points into the list is handed out, since another thread could remove it:
+// lookups return copies of keys and values. To do several things to the list as one step,
+// pass a function to read or write, which runs it with the list locked.
+template<typename Key, typename Value, typename Compare = std::less<Key>, typename Allocator = std::allocator<std::pair<const Key, Value>>>
+class ConcurrentSortedList
+{
+public:
+	using List = SortedList<Key, Value, Compare, Allocator>;
+
+	ConcurrentSortedList();
+	explicit ConcurrentSortedList(const Compare & comp, const Allocator & a = Allocator());
+
+	// A lock can't be copied or moved, so neither can the list; use snapshot for a copy
+	ConcurrentSortedList(const ConcurrentSortedList &) = delete;
+	ConcurrentSortedList & operator=(const ConcurrentSortedList &) = delete;
+
+
+	size_t size() const;
+	bool isEmpty() const;
+
+	// If this key is already present, return false.
+	// otherwise, return true after inserting this key/value pair.
+	bool insert(const Key &k, const Value &v);
+	bool insert(Key &&k, Value &&v);
+
+	// If this key is already present, return false without making a value.
+	// otherwise, return true after inserting this key with a value made from args.
+	template<typename... Args>
+	bool try_emplace(const Key &k, Args&&... args);
+
+	// removes the given key (and its associated value) from the list.
+	// If that key is not in the list, this will silently do nothing.
+	void remove(const Key &k);
+
+	// removes every key that is >= lo and < hi, and returns how many there were.
+	size_t removeRange(const Key &lo, const Key &hi);
+
+	// Return true if this list contains a mapping of this key.
+	bool contains(const Key &k) const;
+
+	// returns a copy of this key's value, or std::nullopt if it is not in the list
+	std::optional<Value> tryGet(const Key &k) const;
+
+	// returns a copy of this key's value.
+	// If this key does not exist in the list, this throws a KeyNotFoundException.
+	Value operator[] (const Key &k) const;
+
+	// If this key exists in the list, this function returns how many keys are in the list that are less than it.
+	// If this key does not exist in the list, this throws a KeyNotFoundException.
+	unsigned getIndex(const Key &k) const;
+
+	// returns the largest key in the list that is < the given key,
+	// or the smallest key in the list that is > the given key.
+	// If no such element exists, these throw a KeyNotFoundException.
+	Key largestLessThan(const Key & k) const;
+	Key smallestGreaterThan(const Key & k) const;
+
+	// returns a copy of the whole list as it is now. The copy shares the list's Nodes, so this is O(1),
+	// but the next change to the list (or to the copy) copies them. Once a function passed to write has
+	// taken an iterator or a value reference from the list, snapshots are deep copies (O(n)) instead.
+	List snapshot() const;
+
+	// Runs f(list) with the list locked for reading (f gets a const List &) or for writing (a List &),
+	// and returns what it returns. f must not call back into this ConcurrentSortedList,
+	// and must not return a reference or iterator into the list, which is unlocked once f returns.
+	template<typename F>
+	decltype(auto) read(F && f) const;
+	template<typename F>
+	decltype(auto) write(F && f);
+
+private:
+	// shared by readers, held alone by writers
+	mutable std::shared_mutex mutex;
+	List list;
+};
+
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+ConcurrentSortedList<Key,Value,Compare,Allocator>::ConcurrentSortedList()
+	: list()
+{}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+ConcurrentSortedList<Key,Value,Compare,Allocator>::ConcurrentSortedList(const Compare & comp, const Allocator & a)
+	: list(comp, a)
+{}
+
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+size_t ConcurrentSortedList<Key,Value,Compare,Allocator>::size() const
+{
+	std::shared_lock lock(mutex);
+	return list.size();
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+bool ConcurrentSortedList<Key,Value,Compare,Allocator>::isEmpty() const
+{
+	std::shared_lock lock(mutex);
+	return list.isEmpty();
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+bool ConcurrentSortedList<Key,Value,Compare,Allocator>::insert(const Key &k, const Value &v)
+{
+	std::unique_lock lock(mutex);
+	return list.insert(k, v);
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+bool ConcurrentSortedList<Key,Value,Compare,Allocator>::insert(Key &&k, Value &&v)
+{
+	std::unique_lock lock(mutex);
+	return list.insert(std::move(k), std::move(v));
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+template<typename... Args>
+bool ConcurrentSortedList<Key,Value,Compare,Allocator>::try_emplace(const Key &k, Args&&... args)
+{
+	std::unique_lock lock(mutex);
+	return list.try_emplace(k, std::forward<Args>(args)...);
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+void ConcurrentSortedList<Key,Value,Compare,Allocator>::remove(const Key &k)
+{
+	std::unique_lock lock(mutex);
+	list.remove(k);
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+size_t ConcurrentSortedList<Key,Value,Compare,Allocator>::removeRange(const Key &lo, const Key &hi)
+{
+	std::unique_lock lock(mutex);
+	return list.removeRange(lo, hi);
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+bool ConcurrentSortedList<Key,Value,Compare,Allocator>::contains(const Key &k) const
+{
+	std::shared_lock lock(mutex);
+	return list.contains(k);
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+std::optional<Value> ConcurrentSortedList<Key,Value,Compare,Allocator>::tryGet(const Key &k) const
+{
+	std::shared_lock lock(mutex);
+	// Copy the value while the lock still keeps its Node in the list
+	if (const Value* value = list.tryGet(k))
+	{
+		return *value;
+	}
+	return std::nullopt;
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+Value ConcurrentSortedList<Key,Value,Compare,Allocator>::operator[] (const Key &k) const
+{
+	std::shared_lock lock(mutex);
+	return std::as_const(list)[k];
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+unsigned ConcurrentSortedList<Key,Value,Compare,Allocator>::getIndex(const Key &k) const
+{
+	std::shared_lock lock(mutex);
+	return list.getIndex(k);
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+Key ConcurrentSortedList<Key,Value,Compare,Allocator>::largestLessThan(const Key & k) const
+{
+	std::shared_lock lock(mutex);
+	return list.largestLessThan(k);
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+Key ConcurrentSortedList<Key,Value,Compare,Allocator>::smallestGreaterThan(const Key & k) const
+{
+	std::shared_lock lock(mutex);
+	return list.smallestGreaterThan(k);
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+typename ConcurrentSortedList<Key,Value,Compare,Allocator>::List ConcurrentSortedList<Key,Value,Compare,Allocator>::snapshot() const
+{
+	std::shared_lock lock(mutex);
+	return list;
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+template<typename F>
+decltype(auto) ConcurrentSortedList<Key,Value,Compare,Allocator>::read(F && f) const
+{
+	std::shared_lock lock(mutex);
+	return std::forward<F>(f)(std::as_const(list));
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+template<typename F>
+decltype(auto) ConcurrentSortedList<Key,Value,Compare,Allocator>::write(F && f)
+{
+	std::unique_lock lock(mutex);
+	return std::forward<F>(f)(list);
+}
+
+
+#endif
@@ -0,0 +1,232 @@
+#ifndef __EPOCH_RECLAIMER_HPP
+#define __EPOCH_RECLAIMER_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+// Epoch-based reclamation, for lock-free structures whose readers don't take locks.
+// Memory that a thread unlinks can't be freed straight away, since other threads may still be
+// reading it. So every thread holds a Guard while it reads, and memory is retired instead of freed:
+// it is freed once the global epoch has moved on twice since, which can only happen after every thread
+// that held a Guard when it was retired has let go of it.
+//
+// All structures share one epoch, and every thread gets a record the first time it takes a Guard.
+// A thread's record is reused by a later thread once it exits.
+class EpochReclaimer
+{
+public:
+	// Marks the calling thread as reading shared memory for as long as the Guard lives.
+	// Guards can be nested; only the outermost one counts.
+	class Guard
+	{
+	public:
+		Guard();
+		~Guard();
+
+		Guard(const Guard &) = delete;
+		Guard & operator=(const Guard &) = delete;
+	};
+
+	// Hands p over to be freed by deleter(p) once no thread can still be reading it.
+	// It must already be unreachable for any thread that takes a Guard from now on.
+	static void retire(void* p, void (*deleter)(void*));
+
+private:
+	// How many retires a thread makes between tries to move the epoch on
+	static constexpr unsigned RetiresPerAdvance = 64;
+
+	struct Retired
+	{
+		void* p;
+		void (*deleter)(void*);
+		// the epoch it was retired in
+		std::uint64_t epoch;
+	};
+
+	// what one thread has announced, and what it has retired but not freed yet
+	struct ThreadRecord
+	{
+		// the epoch the thread saw when it took its Guard, and whether it holds one
+		std::atomic<std::uint64_t> epoch{0};
+		std::atomic<bool> active{false};
+		// whether a running thread owns this record
+		std::atomic<bool> inUse{true};
+		ThreadRecord* next = nullptr;
+
+		// only touched by the owning thread
+		unsigned depth = 0;
+		unsigned retiresSinceAdvance = 0;
+		std::vector<Retired> limbo;
+	};
+
+	// the state shared by every thread
+	struct Registry
+	{
+		std::atomic<std::uint64_t> epoch{0};
+		std::atomic<ThreadRecord*> records{nullptr};
+		// what exited threads left unfreed
+		std::mutex orphanMutex;
+		std::vector<Retired> orphans;
+
+		// Only runs when the program ends, when no thread can be reading anything
+		~Registry();
+	};
+
+	// gives a record back when its thread exits, handing what is left in its limbo to the orphans
+	struct ThreadHolder
+	{
+		ThreadRecord* record;
+		~ThreadHolder();
+	};
+
+	static Registry & registry();
+	static ThreadRecord & threadRecord();
+	static ThreadRecord* acquireRecord();
+
+	// moves the epoch on if every thread holding a Guard has seen the current one
+	static void tryAdvance();
+	// frees everything in limbo that was retired at least two epochs before epoch
+	static void freeOld(std::vector<Retired> & limbo, std::uint64_t epoch);
+};
+
+
+inline EpochReclaimer::Guard::Guard()
+{
+	ThreadRecord & record = threadRecord();
+	if (record.depth++ == 0)
+	{
+		// Announce first, then read the epoch: a thread that sees this one active with an old epoch
+		// just doesn't move the epoch on yet
+		record.active.store(true);
+		record.epoch.store(registry().epoch.load());
+	}
+}
+
+inline EpochReclaimer::Guard::~Guard()
+{
+	ThreadRecord & record = threadRecord();
+	if (--record.depth == 0)
+	{
+		record.active.store(false);
+	}
+}
+
+inline void EpochReclaimer::retire(void* p, void (*deleter)(void*))
+{
+	ThreadRecord & record = threadRecord();
+	record.limbo.push_back(Retired{p, deleter, registry().epoch.load()});
+	if (++record.retiresSinceAdvance >= RetiresPerAdvance)
+	{
+		record.retiresSinceAdvance = 0;
+		tryAdvance();
+		std::uint64_t epoch = registry().epoch.load();
+		freeOld(record.limbo, epoch);
+		// Exited threads' leftovers are freed by whoever gets to them, without waiting for the lock
+		Registry & shared = registry();
+		std::unique_lock lock(shared.orphanMutex, std::try_to_lock);
+		if (lock.owns_lock())
+		{
+			freeOld(shared.orphans, epoch);
+		}
+	}
+}
+
+inline EpochReclaimer::Registry::~Registry()
+{
+	for (Retired & retired : orphans)
+	{
+		retired.deleter(retired.p);
+	}
+	ThreadRecord* record = records.load();
+	while (record != nullptr)
+	{
+		ThreadRecord* next = record->next;
+		delete record;
+		record = next;
+	}
+}
+
+inline EpochReclaimer::ThreadHolder::~ThreadHolder()
+{
+	Registry & shared = registry();
+	{
+		std::lock_guard lock(shared.orphanMutex);
+		shared.orphans.insert(shared.orphans.end(), record->limbo.begin(), record->limbo.end());
+	}
+	record->limbo.clear();
+	record->retiresSinceAdvance = 0;
+	record->inUse.store(false);
+}
+
+inline EpochReclaimer::Registry & EpochReclaimer::registry()
+{
+	static Registry shared;
+	return shared;
+}
+
+inline EpochReclaimer::ThreadRecord & EpochReclaimer::threadRecord()
+{
+	// Make sure the Registry outlives every thread's holder, including the main thread's
+	registry();
+	thread_local ThreadHolder holder{acquireRecord()};
+	return *holder.record;
+}
+
+inline EpochReclaimer::ThreadRecord* EpochReclaimer::acquireRecord()
+{
+	Registry & shared = registry();
+	// Reuse the record of a thread that has exited, if there is one
+	for (ThreadRecord* record = shared.records.load(); record != nullptr; record = record->next)
+	{
+		bool inUse = false;
+		if (record->inUse.compare_exchange_strong(inUse, true))
+		{
+			return record;
+		}
+	}
+	// If not, push a new one on the front of the list
+	ThreadRecord* record = new ThreadRecord;
+	record->next = shared.records.load();
+	while (! shared.records.compare_exchange_weak(record->next, record))
+	{
+	}
+	return record;
+}
+
+inline void EpochReclaimer::tryAdvance()
+{
+	Registry & shared = registry();
+	std::uint64_t epoch = shared.epoch.load();
+	for (ThreadRecord* record = shared.records.load(); record != nullptr; record = record->next)
+	{
+		if (record->inUse.load() && record->active.load() && record->epoch.load() != epoch)
+		{
+			return;
+		}
+	}
+	// If another thread moved it on first, that is just as good
+	shared.epoch.compare_exchange_strong(epoch, epoch + 1);
+}
+
+inline void EpochReclaimer::freeOld(std::vector<Retired> & limbo, std::uint64_t epoch)
+{
+	auto kept = limbo.begin();
+	for (Retired & retired : limbo)
+	{
+		if (retired.epoch + 2 <= epoch)
+		{
+			retired.deleter(retired.p);
+		}
+		else
+		{
+			*kept++ = retired;
+		}
+	}
+	limbo.erase(kept, limbo.end());
+}
+
+
+#endif
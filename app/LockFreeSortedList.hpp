@@ -0,0 +1,494 @@
+#ifndef __LOCK_FREE_SORTED_LIST_HPP
+#define __LOCK_FREE_SORTED_LIST_HPP
+
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <utility>
+#include "EpochReclaimer.hpp"
+#include "SortedList.hpp"
+
+// A sorted map that any number of threads can use at once without taking a lock:
+// a skip list whose links are changed with compare-and-swap (Fraser's lock-free skip list).
+// Lookups never write to shared memory, and a thread that is stopped part way through an insert or remove
+// doesn't hold anyone else up.
+//
+// A Node is removed by marking its links (the low bit of each one): first the upper levels,
+// then level 0, which is the moment it leaves the list. Whoever walks past a marked Node unlinks it.
+// Unlinked Nodes are freed through EpochReclaimer, once no thread can still be reading them.
+//
+// Only what can be done as one step is offered: keys and values can't be changed once they are in,
+// and lookups return copies of them. size is exact only when no thread is changing the list.
+template<typename Key, typename Value, typename Compare = std::less<Key>>
+class LockFreeSortedList
+{
+public:
+	LockFreeSortedList();
+	explicit LockFreeSortedList(const Compare & comp);
+
+	// No other thread may be using the list when it is destroyed
+	~LockFreeSortedList();
+
+	LockFreeSortedList(const LockFreeSortedList &) = delete;
+	LockFreeSortedList & operator=(const LockFreeSortedList &) = delete;
+
+
+	size_t size() const noexcept;
+	bool isEmpty() const noexcept;
+
+	// If this key is already present, return false.
+	// otherwise, return true after inserting this key/value pair.
+	bool insert(const Key &k, const Value &v);
+	bool insert(Key &&k, Value &&v);
+
+	// removes the given key (and its associated value) from the list.
+	// If that key is not in the list, this will silently do nothing.
+	void remove(const Key &k);
+
+	// Return true if this list contains a mapping of this key.
+	bool contains(const Key &k) const;
+
+	// returns a copy of this key's value, or std::nullopt if it is not in the list
+	std::optional<Value> tryGet(const Key &k) const;
+
+	// returns a copy of this key's value.
+	// If this key does not exist in the list, this throws a KeyNotFoundException.
+	Value operator[] (const Key &k) const;
+
+	// returns the largest key in the list that is < the given key,
+	// or the smallest key in the list that is > the given key.
+	// If no such element exists, these throw a KeyNotFoundException.
+	Key largestLessThan(const Key & k) const;
+	Key smallestGreaterThan(const Key & k) const;
+
+private:
+	// as in SortedList
+	static constexpr unsigned MaxLevel = 24;
+
+	// Who has finished with a Node: it is retired by the second of its inserter and remover to finish
+	static constexpr unsigned Inserted = 1;
+	static constexpr unsigned Removed = 2;
+
+	struct Node
+	{
+		const Key key;
+		const Value value;
+		unsigned height;
+		// the next Node on each level, with the low bit set once this Node is being removed
+		std::atomic<std::uintptr_t>* next;
+		std::atomic<unsigned> finished;
+
+		template<typename K, typename V>
+		Node(unsigned h, K&& k, V&& v)
+			: key(std::forward<K>(k)), value(std::forward<V>(v)), height(h),
+			  next(new std::atomic<std::uintptr_t>[h]), finished(0) {}
+
+		~Node()
+		{
+			delete[] next;
+		}
+	};
+
+	// Snipping out marked Nodes changes the links, but not what is in the list, so lookups can do it too
+	mutable std::atomic<std::uintptr_t> headLinks[MaxLevel];
+	std::atomic<size_t> count;
+	[[no_unique_address]] Compare compare;
+
+	static Node* pointer(std::uintptr_t link) noexcept;
+	static bool isMarked(std::uintptr_t link) noexcept;
+	static std::uintptr_t linkTo(Node* n) noexcept;
+	static void deleteNode(void* n) noexcept;
+
+	// the link out of a Node on the given level; a nullptr Node stands for the head of the list
+	std::atomic<std::uintptr_t> & linkAt(Node* x, unsigned level) const noexcept;
+
+	// Each thread has its own generator, as in SortedList
+	static unsigned randomHeight() noexcept;
+
+	// Fills preds and succs with the last Node on each level whose key is < k and the Node after it,
+	// unlinking marked Nodes on the way.
+	// returns true if succs[0] is a Node with key k.
+	bool find(const Key & k, Node** preds, Node** succs) const;
+
+	// The same walk without writing anything: marked Nodes are stepped over.
+	// returns the first unmarked Node on level 0 whose key is >= k (or > k, if pastK),
+	// and leaves the last Node before it in pred.
+	Node* search(const Key & k, bool pastK, Node* & pred) const;
+
+	template<typename K, typename V>
+	bool insertNode(K&& k, V&& v);
+
+	// links n (already in level 0) into its upper levels, unless it is removed first
+	void linkUpperLevels(Node* n, Node** preds, Node** succs);
+
+	// called by n's inserter and its remover once each is done with it; the second one retires it
+	void finish(Node* n, unsigned who);
+};
+
+
+template<typename Key, typename Value, typename Compare>
+LockFreeSortedList<Key,Value,Compare>::LockFreeSortedList()
+	: count(0), compare()
+{
+	for (std::atomic<std::uintptr_t> & link : headLinks)
+	{
+		link.store(0, std::memory_order_relaxed);
+	}
+}
+
+template<typename Key, typename Value, typename Compare>
+LockFreeSortedList<Key,Value,Compare>::LockFreeSortedList(const Compare & comp)
+	: LockFreeSortedList()
+{
+	compare = comp;
+}
+
+template<typename Key, typename Value, typename Compare>
+LockFreeSortedList<Key,Value,Compare>::~LockFreeSortedList()
+{
+	// Every Node still in level 0 is in the list; the ones removed are already retired
+	Node* n = pointer(headLinks[0].load());
+	while (n != nullptr)
+	{
+		Node* next = pointer(n->next[0].load());
+		delete n;
+		n = next;
+	}
+}
+
+
+template<typename Key, typename Value, typename Compare>
+typename LockFreeSortedList<Key,Value,Compare>::Node* LockFreeSortedList<Key,Value,Compare>::pointer(std::uintptr_t link) noexcept
+{
+	return reinterpret_cast<Node*>(link & ~std::uintptr_t(1));
+}
+
+template<typename Key, typename Value, typename Compare>
+bool LockFreeSortedList<Key,Value,Compare>::isMarked(std::uintptr_t link) noexcept
+{
+	return link & 1;
+}
+
+template<typename Key, typename Value, typename Compare>
+std::uintptr_t LockFreeSortedList<Key,Value,Compare>::linkTo(Node* n) noexcept
+{
+	return reinterpret_cast<std::uintptr_t>(n);
+}
+
+template<typename Key, typename Value, typename Compare>
+void LockFreeSortedList<Key,Value,Compare>::deleteNode(void* n) noexcept
+{
+	delete static_cast<Node*>(n);
+}
+
+template<typename Key, typename Value, typename Compare>
+std::atomic<std::uintptr_t> & LockFreeSortedList<Key,Value,Compare>::linkAt(Node* x, unsigned level) const noexcept
+{
+	return x != nullptr ? x->next[level] : headLinks[level];
+}
+
+template<typename Key, typename Value, typename Compare>
+unsigned LockFreeSortedList<Key,Value,Compare>::randomHeight() noexcept
+{
+	thread_local std::uint64_t heightSeed = 0x9E3779B97F4A7C15ull ^ reinterpret_cast<std::uintptr_t>(&heightSeed);
+	heightSeed ^= heightSeed << 13;
+	heightSeed ^= heightSeed >> 7;
+	heightSeed ^= heightSeed << 17;
+	unsigned height = 1 + std::countr_zero(heightSeed) / 2;
+	return height < MaxLevel ? height : MaxLevel;
+}
+
+
+template<typename Key, typename Value, typename Compare>
+bool LockFreeSortedList<Key,Value,Compare>::find(const Key & k, Node** preds, Node** succs) const
+{
+	bool restart = true;
+	while (restart)
+	{
+		restart = false;
+		Node* pred = nullptr;
+		for (unsigned level = MaxLevel; level-- > 0 && ! restart;)
+		{
+			Node* curr = pointer(linkAt(pred, level).load());
+			while (curr != nullptr)
+			{
+				std::uintptr_t succ = curr->next[level].load();
+				if (isMarked(succ))
+				{
+					// curr is being removed: unlink it here. If pred has changed (or is being removed itself),
+					// start again from the top
+					std::uintptr_t expected = linkTo(curr);
+					if (! linkAt(pred, level).compare_exchange_strong(expected, linkTo(pointer(succ))))
+					{
+						restart = true;
+						break;
+					}
+					curr = pointer(succ);
+				}
+				else if (compare(curr->key, k))
+				{
+					pred = curr;
+					curr = pointer(succ);
+				}
+				else
+				{
+					break;
+				}
+			}
+			preds[level] = pred;
+			succs[level] = curr;
+		}
+	}
+	return succs[0] != nullptr && ! compare(k, succs[0]->key);
+}
+
+template<typename Key, typename Value, typename Compare>
+typename LockFreeSortedList<Key,Value,Compare>::Node* LockFreeSortedList<Key,Value,Compare>::search(const Key & k, bool pastK, Node* & pred) const
+{
+	pred = nullptr;
+	Node* curr = nullptr;
+	for (unsigned level = MaxLevel; level-- > 0;)
+	{
+		curr = pointer(linkAt(pred, level).load());
+		while (curr != nullptr)
+		{
+			std::uintptr_t succ = curr->next[level].load();
+			if (isMarked(succ))
+			{
+				curr = pointer(succ);
+			}
+			else if (compare(curr->key, k) || (pastK && ! compare(k, curr->key)))
+			{
+				pred = curr;
+				curr = pointer(succ);
+			}
+			else
+			{
+				break;
+			}
+		}
+	}
+	return curr;
+}
+
+
+template<typename Key, typename Value, typename Compare>
+size_t LockFreeSortedList<Key,Value,Compare>::size() const noexcept
+{
+	return count.load();
+}
+
+template<typename Key, typename Value, typename Compare>
+bool LockFreeSortedList<Key,Value,Compare>::isEmpty() const noexcept
+{
+	return size() == 0;
+}
+
+template<typename Key, typename Value, typename Compare>
+bool LockFreeSortedList<Key,Value,Compare>::insert(const Key &k, const Value &v)
+{
+	return insertNode(k, v);
+}
+
+template<typename Key, typename Value, typename Compare>
+bool LockFreeSortedList<Key,Value,Compare>::insert(Key &&k, Value &&v)
+{
+	return insertNode(std::move(k), std::move(v));
+}
+
+template<typename Key, typename Value, typename Compare>
+template<typename K, typename V>
+bool LockFreeSortedList<Key,Value,Compare>::insertNode(K&& k, V&& v)
+{
+	EpochReclaimer::Guard guard;
+	Node* preds[MaxLevel];
+	Node* succs[MaxLevel];
+	// The Node is only made once the key is known to be missing; after that, its key is the one looked for
+	Node* n = nullptr;
+	while (true)
+	{
+		if (find(n != nullptr ? n->key : k, preds, succs))
+		{
+			// Nobody else has seen n, so it can go straight away
+			delete n;
+			return false;
+		}
+		if (n == nullptr)
+		{
+			n = new Node(randomHeight(), std::forward<K>(k), std::forward<V>(v));
+		}
+		for (unsigned level = 0; level < n->height; level++)
+		{
+			n->next[level].store(linkTo(succs[level]), std::memory_order_relaxed);
+		}
+		// Linking it into level 0 puts it in the list
+		std::uintptr_t expected = linkTo(succs[0]);
+		if (linkAt(preds[0], 0).compare_exchange_strong(expected, linkTo(n)))
+		{
+			break;
+		}
+	}
+	count++;
+	linkUpperLevels(n, preds, succs);
+	finish(n, Inserted);
+	return true;
+}
+
+template<typename Key, typename Value, typename Compare>
+void LockFreeSortedList<Key,Value,Compare>::linkUpperLevels(Node* n, Node** preds, Node** succs)
+{
+	for (unsigned level = 1; level < n->height; level++)
+	{
+		while (true)
+		{
+			// Point n at its successor on this level, unless a remover has marked the link already
+			std::uintptr_t link = n->next[level].load();
+			if (isMarked(link))
+			{
+				return;
+			}
+			if (pointer(link) != succs[level] && ! n->next[level].compare_exchange_strong(link, linkTo(succs[level])))
+			{
+				continue;
+			}
+			std::uintptr_t expected = linkTo(succs[level]);
+			if (linkAt(preds[level], level).compare_exchange_strong(expected, linkTo(n)))
+			{
+				break;
+			}
+			// Something changed around it on this level: look again, and give up if n has been removed
+			find(n->key, preds, succs);
+			if (succs[0] != n)
+			{
+				return;
+			}
+		}
+	}
+}
+
+template<typename Key, typename Value, typename Compare>
+void LockFreeSortedList<Key,Value,Compare>::remove(const Key &k)
+{
+	EpochReclaimer::Guard guard;
+	Node* preds[MaxLevel];
+	Node* succs[MaxLevel];
+	if (! find(k, preds, succs))
+	{
+		return;
+	}
+	Node* n = succs[0];
+	// Mark the upper levels from the top down, so that no search finds it on the way down once it is gone
+	for (unsigned level = n->height; level-- > 1;)
+	{
+		std::uintptr_t link = n->next[level].load();
+		while (! isMarked(link) && ! n->next[level].compare_exchange_weak(link, link | 1))
+		{
+		}
+	}
+	// Whoever marks level 0 removes it
+	std::uintptr_t link = n->next[0].load();
+	while (true)
+	{
+		if (isMarked(link))
+		{
+			return;
+		}
+		if (n->next[0].compare_exchange_weak(link, link | 1))
+		{
+			break;
+		}
+	}
+	count--;
+	// Walking past it unlinks it from every level it is linked into
+	find(k, preds, succs);
+	finish(n, Removed);
+}
+
+template<typename Key, typename Value, typename Compare>
+void LockFreeSortedList<Key,Value,Compare>::finish(Node* n, unsigned who)
+{
+	if (n->finished.fetch_or(who) == 0)
+	{
+		return;
+	}
+	// The inserter can link n into a level after the remover has unlinked it from them,
+	// so if the inserter finishes second, it unlinks n again
+	if (who == Inserted)
+	{
+		Node* preds[MaxLevel];
+		Node* succs[MaxLevel];
+		find(n->key, preds, succs);
+	}
+	EpochReclaimer::retire(n, deleteNode);
+}
+
+
+template<typename Key, typename Value, typename Compare>
+bool LockFreeSortedList<Key,Value,Compare>::contains(const Key &k) const
+{
+	EpochReclaimer::Guard guard;
+	Node* pred;
+	Node* n = search(k, false, pred);
+	return n != nullptr && ! compare(k, n->key);
+}
+
+template<typename Key, typename Value, typename Compare>
+std::optional<Value> LockFreeSortedList<Key,Value,Compare>::tryGet(const Key &k) const
+{
+	EpochReclaimer::Guard guard;
+	Node* pred;
+	Node* n = search(k, false, pred);
+	if (n != nullptr && ! compare(k, n->key))
+	{
+		return n->value;
+	}
+	return std::nullopt;
+}
+
+template<typename Key, typename Value, typename Compare>
+Value LockFreeSortedList<Key,Value,Compare>::operator[] (const Key &k) const
+{
+	if (std::optional<Value> value = tryGet(k))
+	{
+		return std::move(*value);
+	}
+	throw KeyNotFoundException{"Key not found in list"};
+}
+
+template<typename Key, typename Value, typename Compare>
+Key LockFreeSortedList<Key,Value,Compare>::largestLessThan(const Key & k) const
+{
+	EpochReclaimer::Guard guard;
+	while (true)
+	{
+		Node* pred;
+		search(k, false, pred);
+		if (pred == nullptr)
+		{
+			throw KeyNotFoundException{"Key not found in list"};
+		}
+		// The walk may have come down onto a Node that was removed since; if so, look again
+		if (! isMarked(pred->next[0].load()))
+		{
+			return pred->key;
+		}
+	}
+}
+
+template<typename Key, typename Value, typename Compare>
+Key LockFreeSortedList<Key,Value,Compare>::smallestGreaterThan(const Key & k) const
+{
+	EpochReclaimer::Guard guard;
+	Node* pred;
+	Node* n = search(k, true, pred);
+	if (n == nullptr)
+	{
+		throw KeyNotFoundException{"Key not found in list"};
+	}
+	return n->key;
+}
+
+
+#endif
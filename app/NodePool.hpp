@@ -0,0 +1,163 @@
+#ifndef __NODE_POOL_HPP
+#define __NODE_POOL_HPP
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+// A pool of storage for objects of type T (the Nodes of a list).
+// Storage is taken from Allocator in slabs that hold many Ts, and handed out
+// one T at a time by bumping a pointer through the newest slab.
+// Storage that is given back goes on a free list and is reused before the slab is touched again.
+// The slabs themselves are only given back to Allocator when the pool is destroyed.
+//
+// The pool only deals in raw storage: constructing and destroying the Ts is up to the caller.
+template<typename T, typename Allocator = std::allocator<T>>
+class NodePool
+{
+private:
+	// a piece of storage big enough for a T, or for the bookkeeping of the pool when it isn't one
+	union Slot
+	{
+		// the next piece of storage on the free list
+		Slot* nextFree;
+		// the first Slot of every slab records the slab before it, and how many Slots it has
+		struct
+		{
+			Slot* previous;
+			size_t size;
+		} slab;
+		alignas(T) unsigned char storage[sizeof(T)];
+	};
+
+	using SlotAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Slot>;
+	using SlotTraits = std::allocator_traits<SlotAllocator>;
+
+	// The first slab holds this many Slots; each new slab is twice as big, up to the maximum
+	static constexpr size_t FirstSlabSize = 16;
+	static constexpr size_t MaxSlabSize = 4096;
+
+	[[no_unique_address]] SlotAllocator allocator;
+	// the newest slab, and the part of it that has never been handed out
+	Slot* slabs;
+	Slot* bump;
+	Slot* bumpEnd;
+	// storage that was handed out and given back
+	Slot* freeList;
+
+	// takes a new slab from the allocator and starts bumping through it
+	void grow();
+
+public:
+	explicit NodePool(const Allocator & a = Allocator());
+	~NodePool();
+
+	NodePool(const NodePool &) = delete;
+	NodePool & operator=(const NodePool &) = delete;
+
+	// takes over other's slabs and free list, leaving other empty
+	NodePool(NodePool && other) noexcept;
+	// trades slabs, free lists and allocators with other
+	void swap(NodePool & other) noexcept;
+
+	// returns uninitialized storage for one T
+	T* allocate();
+	// gives back storage from allocate(), after the T in it has been destroyed
+	void deallocate(T* p) noexcept;
+
+	// returns a copy of the allocator the slabs are taken from
+	Allocator get_allocator() const noexcept;
+};
+
+
+template<typename T, typename Allocator>
+NodePool<T,Allocator>::NodePool(const Allocator & a)
+	: allocator(a), slabs(nullptr), bump(nullptr), bumpEnd(nullptr), freeList(nullptr)
+{}
+
+template<typename T, typename Allocator>
+NodePool<T,Allocator>::~NodePool()
+{
+	// Give every slab back to the allocator, newest first
+	while (slabs != nullptr)
+	{
+		Slot* previous = slabs->slab.previous;
+		SlotTraits::deallocate(allocator, slabs, slabs->slab.size);
+		slabs = previous;
+	}
+}
+
+template<typename T, typename Allocator>
+NodePool<T,Allocator>::NodePool(NodePool && other) noexcept
+	: allocator(std::move(other.allocator)), slabs(other.slabs), bump(other.bump), bumpEnd(other.bumpEnd), freeList(other.freeList)
+{
+	other.slabs = nullptr;
+	other.bump = nullptr;
+	other.bumpEnd = nullptr;
+	other.freeList = nullptr;
+}
+
+template<typename T, typename Allocator>
+void NodePool<T,Allocator>::swap(NodePool & other) noexcept
+{
+	using std::swap;
+	swap(allocator, other.allocator);
+	swap(slabs, other.slabs);
+	swap(bump, other.bump);
+	swap(bumpEnd, other.bumpEnd);
+	swap(freeList, other.freeList);
+}
+
+template<typename T, typename Allocator>
+void NodePool<T,Allocator>::grow()
+{
+	// Double the size of the newest slab, so the number of slabs stays logarithmic
+	size_t size = slabs == nullptr ? FirstSlabSize : slabs->slab.size * 2;
+	if (size > MaxSlabSize)
+	{
+		size = MaxSlabSize;
+	}
+	Slot* slab = SlotTraits::allocate(allocator, size);
+	// The first Slot keeps track of the slab, the rest are handed out
+	slab->slab.previous = slabs;
+	slab->slab.size = size;
+	slabs = slab;
+	bump = slab + 1;
+	bumpEnd = slab + size;
+}
+
+template<typename T, typename Allocator>
+T* NodePool<T,Allocator>::allocate()
+{
+	// Reuse storage that was given back if there is any
+	if (freeList != nullptr)
+	{
+		Slot* slot = freeList;
+		freeList = slot->nextFree;
+		return reinterpret_cast<T*>(slot->storage);
+	}
+	// Otherwise, hand out the next Slot of the newest slab
+	if (bump == bumpEnd)
+	{
+		grow();
+	}
+	return reinterpret_cast<T*>((bump++)->storage);
+}
+
+template<typename T, typename Allocator>
+void NodePool<T,Allocator>::deallocate(T* p) noexcept
+{
+	// Push the storage on the free list
+	Slot* slot = reinterpret_cast<Slot*>(p);
+	slot->nextFree = freeList;
+	freeList = slot;
+}
+
+template<typename T, typename Allocator>
+Allocator NodePool<T,Allocator>::get_allocator() const noexcept
+{
+	return Allocator(allocator);
+}
+
+
+#endif
@@ -0,0 +1,641 @@
+#ifndef __PERSISTENT_SORTED_LIST_HPP
+#define __PERSISTENT_SORTED_LIST_HPP
+
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "SortedList.hpp"
+
+// An immutable version of a PersistentSortedList: the keys and values it held when the version was taken.
+// A version is a root into a tree of Nodes that no one ever changes, so it can be read from any thread,
+// it stays the same however the list goes on changing, and copying it is O(1).
+// Its Nodes are shared with the list and with other versions, and are freed once nothing uses them.
+template<typename Key, typename Value, typename Compare = std::less<Key>, typename Allocator = std::allocator<std::pair<const Key, Value>>>
+class SortedListSnapshot
+{
+public:
+	// a key and its value, as seen through an iterator. Neither can be changed.
+	struct Entry
+	{
+		const Key key;
+		const Value value;
+	};
+
+	SortedListSnapshot();
+	explicit SortedListSnapshot(const Compare & comp, const Allocator & a = Allocator());
+
+	Allocator get_allocator() const noexcept;
+	Compare key_comp() const;
+
+	size_t size() const noexcept;
+	bool isEmpty() const noexcept;
+
+	// Return true if this version contains a mapping of this key.
+	bool contains(const Key &k) const;
+
+	// returns a pointer to this key's value, or nullptr if it is not in this version.
+	// The value lives as long as any version that has it.
+	const Value* tryGet(const Key &k) const;
+
+	// returns this key's value.
+	// If this key does not exist in this version, this throws a KeyNotFoundException.
+	const Value & operator[] (const Key &k) const;
+
+	// If this key exists, this function returns how many keys are less than it.
+	// If this key does not exist, this throws a KeyNotFoundException.
+	unsigned getIndex(const Key &k) const;
+
+	// returns the key with index i (the one that has i keys less than it).
+	// If there are not more than i keys, this throws a std::out_of_range.
+	const Key & keyAt(unsigned i) const;
+
+	// returns the largest key that is < the given key,
+	// or the smallest key that is > the given key.
+	// If no such element exists, these throw a KeyNotFoundException.
+	const Key & largestLessThan(const Key & k) const;
+	const Key & smallestGreaterThan(const Key & k) const;
+
+	// Two versions are equal if they have the same keys with the same values.
+	// Versions that share their root are equal without a look at their Nodes.
+	bool operator==(const SortedListSnapshot & other) const;
+
+protected:
+	// A Node is never changed once it is in a version: a change makes new copies of the Nodes on the way to it,
+	// which share everything else. Each Node also has a random priority, and no Node has a higher priority
+	// than its parent (a treap), so the tree is balanced whatever order the keys come in.
+	struct Node : Entry
+	{
+		std::shared_ptr<Node> left;
+		std::shared_ptr<Node> right;
+		// the number of Nodes in this subtree, so indexes can be added up while searching
+		size_t size;
+		std::uint64_t priority;
+
+		template<typename K, typename V>
+		Node(K&& k, V&& v, std::uint64_t p)
+			: Entry{std::forward<K>(k), std::forward<V>(v)}, left(), right(), size(1), priority(p) {}
+
+		Node(const Node &) = default;
+	};
+	using NodePtr = std::shared_ptr<Node>;
+	using NodeAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Node>;
+
+	NodePtr root;
+	[[no_unique_address]] Compare compare;
+	[[no_unique_address]] Allocator allocator;
+
+	static size_t sizeOf(const Node* n) noexcept;
+
+	// returns the Node with key k, or nullptr if there is none
+	const Node* findNode(const Key & k) const;
+
+public:
+	// walks the keys in order. A stack holds the Nodes above the current one whose keys come after it,
+	// so iterators are valid for as long as the version they came from.
+	class const_iterator
+	{
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = Entry;
+		using difference_type = std::ptrdiff_t;
+		using pointer = const Entry*;
+		using reference = const Entry&;
+
+		const_iterator() = default;
+		explicit const_iterator(const Node* n) { descend(n); }
+
+		reference operator*() const noexcept { return *above.back(); }
+		pointer operator->() const noexcept { return above.back(); }
+
+		const_iterator & operator++();
+		const_iterator operator++(int) { const_iterator old = *this; ++*this; return old; }
+
+		bool operator==(const const_iterator & other) const noexcept
+		{
+			return above.empty() ? other.above.empty() : ! other.above.empty() && above.back() == other.above.back();
+		}
+
+	private:
+		std::vector<const Node*> above;
+
+		// goes to the smallest key under n
+		void descend(const Node* n);
+	};
+	using iterator = const_iterator;
+
+	const_iterator begin() const;
+	const_iterator end() const noexcept;
+};
+
+
+// A sorted map whose past versions can be kept and read while it goes on changing.
+// snapshot() is O(1): it returns the current version, which never changes.
+// insert and remove copy only the O(log n) Nodes on the way to their key (path copying),
+// and share the rest of the tree with every earlier version, so keeping a version costs memory only
+// for what changes after it. Keys and values are copied along with the Nodes on the path.
+//
+// A PersistentSortedList is a SortedListSnapshot that can be changed: every lookup of
+// SortedListSnapshot works on it too. Iterators and pointers into the list itself are only valid
+// until its next change; take a snapshot to keep reading a version.
+// Taking a snapshot reads the list, so it has to be kept apart from changes in other threads,
+// but the snapshot can then be read from any thread while the list changes.
+template<typename Key, typename Value, typename Compare = std::less<Key>, typename Allocator = std::allocator<std::pair<const Key, Value>>>
+class PersistentSortedList : public SortedListSnapshot<Key, Value, Compare, Allocator>
+{
+public:
+	using Snapshot = SortedListSnapshot<Key, Value, Compare, Allocator>;
+
+	PersistentSortedList();
+	explicit PersistentSortedList(const Compare & comp, const Allocator & a = Allocator());
+
+	// the list as it is now, which later changes to the list don't touch
+	Snapshot snapshot() const;
+
+	// If this key is already present, return false.
+	// otherwise, return true after inserting this key/value pair.
+	bool insert(const Key &k, const Value &v);
+	bool insert(Key &&k, Value &&v);
+
+	// removes the given key (and its associated value) from the list.
+	// If that key is not in the list, this will silently do nothing.
+	void remove(const Key &k);
+
+private:
+	using Node = typename Snapshot::Node;
+	using NodePtr = typename Snapshot::NodePtr;
+	using NodeAllocator = typename Snapshot::NodeAllocator;
+
+	// state of the generator that picks the priority of new Nodes
+	std::uint64_t prioritySeed;
+
+	std::uint64_t randomPriority() noexcept;
+
+	// makes a new Node, or a copy of n that can be changed until it is put in the tree
+	template<typename K, typename V>
+	NodePtr makeNode(K&& k, V&& v);
+	NodePtr copyNode(const Node & n);
+
+	// Each returns the root of a new version of the subtree t (or t itself, if nothing changed).
+	// Only the Nodes they return new are changed, never the ones they are given.
+	template<typename K, typename V>
+	NodePtr insertInto(const NodePtr & t, K&& k, V&& v, bool & inserted);
+	NodePtr removeFrom(const NodePtr & t, const Key & k, bool & removed);
+	// the Nodes of a and then of b (whose keys all come after a's) as one subtree
+	NodePtr join(const NodePtr & a, const NodePtr & b);
+
+	// Rotations on a new Node n and its new child, which has the higher priority and moves up above n
+	NodePtr rotateRight(NodePtr n) noexcept;
+	NodePtr rotateLeft(NodePtr n) noexcept;
+	static void resize(Node & n) noexcept;
+
+	template<typename K, typename V>
+	bool insertNode(K&& k, V&& v);
+};
+
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+SortedListSnapshot<Key,Value,Compare,Allocator>::SortedListSnapshot()
+	: root(), compare(), allocator()
+{}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+SortedListSnapshot<Key,Value,Compare,Allocator>::SortedListSnapshot(const Compare & comp, const Allocator & a)
+	: root(), compare(comp), allocator(a)
+{}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+Allocator SortedListSnapshot<Key,Value,Compare,Allocator>::get_allocator() const noexcept
+{
+	return allocator;
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+Compare SortedListSnapshot<Key,Value,Compare,Allocator>::key_comp() const
+{
+	return compare;
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+size_t SortedListSnapshot<Key,Value,Compare,Allocator>::sizeOf(const Node* n) noexcept
+{
+	return n != nullptr ? n->size : 0;
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+size_t SortedListSnapshot<Key,Value,Compare,Allocator>::size() const noexcept
+{
+	return sizeOf(root.get());
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+bool SortedListSnapshot<Key,Value,Compare,Allocator>::isEmpty() const noexcept
+{
+	return root == nullptr;
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+const typename SortedListSnapshot<Key,Value,Compare,Allocator>::Node* SortedListSnapshot<Key,Value,Compare,Allocator>::findNode(const Key & k) const
+{
+	const Node* current = root.get();
+	while (current != nullptr)
+	{
+		if (compare(k, current->key))
+		{
+			current = current->left.get();
+		}
+		else if (compare(current->key, k))
+		{
+			current = current->right.get();
+		}
+		else
+		{
+			return current;
+		}
+	}
+	return nullptr;
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+bool SortedListSnapshot<Key,Value,Compare,Allocator>::contains(const Key &k) const
+{
+	return findNode(k) != nullptr;
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+const Value* SortedListSnapshot<Key,Value,Compare,Allocator>::tryGet(const Key &k) const
+{
+	const Node* current = findNode(k);
+	return current != nullptr ? &current->value : nullptr;
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+const Value & SortedListSnapshot<Key,Value,Compare,Allocator>::operator[] (const Key &k) const
+{
+	if (const Node* current = findNode(k))
+	{
+		return current->value;
+	}
+	throw KeyNotFoundException{"Key not found in list"};
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+unsigned SortedListSnapshot<Key,Value,Compare,Allocator>::getIndex(const Key &k) const
+{
+	// Every time the search goes right, the Node and its left subtree come before k
+	size_t index = 0;
+	const Node* current = root.get();
+	while (current != nullptr)
+	{
+		if (compare(k, current->key))
+		{
+			current = current->left.get();
+		}
+		else if (compare(current->key, k))
+		{
+			index += sizeOf(current->left.get()) + 1;
+			current = current->right.get();
+		}
+		else
+		{
+			return static_cast<unsigned>(index + sizeOf(current->left.get()));
+		}
+	}
+	throw KeyNotFoundException{"Key not found in list"};
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+const Key & SortedListSnapshot<Key,Value,Compare,Allocator>::keyAt(unsigned i) const
+{
+	size_t index = i;
+	const Node* current = root.get();
+	while (current != nullptr)
+	{
+		size_t leftSize = sizeOf(current->left.get());
+		if (index < leftSize)
+		{
+			current = current->left.get();
+		}
+		else if (index > leftSize)
+		{
+			index -= leftSize + 1;
+			current = current->right.get();
+		}
+		else
+		{
+			return current->key;
+		}
+	}
+	throw std::out_of_range{"Index out of range"};
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+const Key & SortedListSnapshot<Key,Value,Compare,Allocator>::largestLessThan(const Key & k) const
+{
+	// The last Node the search passed on its left is the answer
+	const Node* found = nullptr;
+	const Node* current = root.get();
+	while (current != nullptr)
+	{
+		if (compare(current->key, k))
+		{
+			found = current;
+			current = current->right.get();
+		}
+		else
+		{
+			current = current->left.get();
+		}
+	}
+	if (found != nullptr)
+	{
+		return found->key;
+	}
+	throw KeyNotFoundException{"Key not found in list"};
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+const Key & SortedListSnapshot<Key,Value,Compare,Allocator>::smallestGreaterThan(const Key & k) const
+{
+	const Node* found = nullptr;
+	const Node* current = root.get();
+	while (current != nullptr)
+	{
+		if (compare(k, current->key))
+		{
+			found = current;
+			current = current->left.get();
+		}
+		else
+		{
+			current = current->right.get();
+		}
+	}
+	if (found != nullptr)
+	{
+		return found->key;
+	}
+	throw KeyNotFoundException{"Key not found in list"};
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+bool SortedListSnapshot<Key,Value,Compare,Allocator>::operator==(const SortedListSnapshot & other) const
+{
+	if (root == other.root)
+	{
+		return true;
+	}
+	if (size() != other.size())
+	{
+		return false;
+	}
+	for (const_iterator a = begin(), b = other.begin(); a != end(); ++a, ++b)
+	{
+		if (a->key != b->key || a->value != b->value)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+void SortedListSnapshot<Key,Value,Compare,Allocator>::const_iterator::descend(const Node* n)
+{
+	for (; n != nullptr; n = n->left.get())
+	{
+		above.push_back(n);
+	}
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+typename SortedListSnapshot<Key,Value,Compare,Allocator>::const_iterator & SortedListSnapshot<Key,Value,Compare,Allocator>::const_iterator::operator++()
+{
+	// The next key is the smallest one in the right subtree, or else the nearest Node above still on the stack
+	const Node* current = above.back();
+	above.pop_back();
+	descend(current->right.get());
+	return *this;
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+typename SortedListSnapshot<Key,Value,Compare,Allocator>::const_iterator SortedListSnapshot<Key,Value,Compare,Allocator>::begin() const
+{
+	return const_iterator(root.get());
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+typename SortedListSnapshot<Key,Value,Compare,Allocator>::const_iterator SortedListSnapshot<Key,Value,Compare,Allocator>::end() const noexcept
+{
+	return const_iterator();
+}
+
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+PersistentSortedList<Key,Value,Compare,Allocator>::PersistentSortedList()
+	: Snapshot(), prioritySeed(0x9E3779B97F4A7C15ull)
+{}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+PersistentSortedList<Key,Value,Compare,Allocator>::PersistentSortedList(const Compare & comp, const Allocator & a)
+	: Snapshot(comp, a), prioritySeed(0x9E3779B97F4A7C15ull)
+{}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+typename PersistentSortedList<Key,Value,Compare,Allocator>::Snapshot PersistentSortedList<Key,Value,Compare,Allocator>::snapshot() const
+{
+	// The Nodes of the current version are never changed, so sharing its root is all it takes
+	return Snapshot(*this);
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+std::uint64_t PersistentSortedList<Key,Value,Compare,Allocator>::randomPriority() noexcept
+{
+	// The same xorshift generator that SortedList uses for heights
+	prioritySeed ^= prioritySeed << 13;
+	prioritySeed ^= prioritySeed >> 7;
+	prioritySeed ^= prioritySeed << 17;
+	return prioritySeed;
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+template<typename K, typename V>
+typename PersistentSortedList<Key,Value,Compare,Allocator>::NodePtr PersistentSortedList<Key,Value,Compare,Allocator>::makeNode(K&& k, V&& v)
+{
+	return std::allocate_shared<Node>(NodeAllocator(this->allocator), std::forward<K>(k), std::forward<V>(v), randomPriority());
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+typename PersistentSortedList<Key,Value,Compare,Allocator>::NodePtr PersistentSortedList<Key,Value,Compare,Allocator>::copyNode(const Node & n)
+{
+	return std::allocate_shared<Node>(NodeAllocator(this->allocator), n);
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+void PersistentSortedList<Key,Value,Compare,Allocator>::resize(Node & n) noexcept
+{
+	n.size = 1 + Snapshot::sizeOf(n.left.get()) + Snapshot::sizeOf(n.right.get());
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+typename PersistentSortedList<Key,Value,Compare,Allocator>::NodePtr PersistentSortedList<Key,Value,Compare,Allocator>::rotateRight(NodePtr n) noexcept
+{
+	NodePtr up = std::move(n->left);
+	n->left = std::move(up->right);
+	resize(*n);
+	up->right = std::move(n);
+	resize(*up);
+	return up;
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+typename PersistentSortedList<Key,Value,Compare,Allocator>::NodePtr PersistentSortedList<Key,Value,Compare,Allocator>::rotateLeft(NodePtr n) noexcept
+{
+	NodePtr up = std::move(n->right);
+	n->right = std::move(up->left);
+	resize(*n);
+	up->left = std::move(n);
+	resize(*up);
+	return up;
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+template<typename K, typename V>
+typename PersistentSortedList<Key,Value,Compare,Allocator>::NodePtr PersistentSortedList<Key,Value,Compare,Allocator>::insertInto(const NodePtr & t, K&& k, V&& v, bool & inserted)
+{
+	if (t == nullptr)
+	{
+		inserted = true;
+		return makeNode(std::forward<K>(k), std::forward<V>(v));
+	}
+	if (this->compare(k, t->key))
+	{
+		NodePtr left = insertInto(t->left, std::forward<K>(k), std::forward<V>(v), inserted);
+		if (! inserted)
+		{
+			return t;
+		}
+		// Copy t to point at the new left subtree, whose root (new too) moves up if its priority is higher
+		NodePtr n = copyNode(*t);
+		n->left = std::move(left);
+		n->size++;
+		return n->left->priority > n->priority ? rotateRight(std::move(n)) : n;
+	}
+	if (this->compare(t->key, k))
+	{
+		NodePtr right = insertInto(t->right, std::forward<K>(k), std::forward<V>(v), inserted);
+		if (! inserted)
+		{
+			return t;
+		}
+		NodePtr n = copyNode(*t);
+		n->right = std::move(right);
+		n->size++;
+		return n->right->priority > n->priority ? rotateLeft(std::move(n)) : n;
+	}
+	// The key is already present, so nothing changes
+	inserted = false;
+	return t;
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+typename PersistentSortedList<Key,Value,Compare,Allocator>::NodePtr PersistentSortedList<Key,Value,Compare,Allocator>::removeFrom(const NodePtr & t, const Key & k, bool & removed)
+{
+	if (t == nullptr)
+	{
+		removed = false;
+		return t;
+	}
+	if (this->compare(k, t->key))
+	{
+		NodePtr left = removeFrom(t->left, k, removed);
+		if (! removed)
+		{
+			return t;
+		}
+		NodePtr n = copyNode(*t);
+		n->left = std::move(left);
+		n->size--;
+		return n;
+	}
+	if (this->compare(t->key, k))
+	{
+		NodePtr right = removeFrom(t->right, k, removed);
+		if (! removed)
+		{
+			return t;
+		}
+		NodePtr n = copyNode(*t);
+		n->right = std::move(right);
+		n->size--;
+		return n;
+	}
+	// t goes, and its subtrees take its place
+	removed = true;
+	return join(t->left, t->right);
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+typename PersistentSortedList<Key,Value,Compare,Allocator>::NodePtr PersistentSortedList<Key,Value,Compare,Allocator>::join(const NodePtr & a, const NodePtr & b)
+{
+	if (a == nullptr)
+	{
+		return b;
+	}
+	if (b == nullptr)
+	{
+		return a;
+	}
+	// The root with the higher priority stays on top, and the other subtree is joined on below it
+	if (a->priority > b->priority)
+	{
+		NodePtr n = copyNode(*a);
+		n->right = join(a->right, b);
+		n->size = a->size + b->size;
+		return n;
+	}
+	NodePtr n = copyNode(*b);
+	n->left = join(a, b->left);
+	n->size = a->size + b->size;
+	return n;
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+template<typename K, typename V>
+bool PersistentSortedList<Key,Value,Compare,Allocator>::insertNode(K&& k, V&& v)
+{
+	// Look first, so a key that is already present costs no copies
+	if (this->contains(k))
+	{
+		return false;
+	}
+	bool inserted = false;
+	this->root = insertInto(this->root, std::forward<K>(k), std::forward<V>(v), inserted);
+	return inserted;
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+bool PersistentSortedList<Key,Value,Compare,Allocator>::insert(const Key &k, const Value &v)
+{
+	return insertNode(k, v);
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+bool PersistentSortedList<Key,Value,Compare,Allocator>::insert(Key &&k, Value &&v)
+{
+	return insertNode(std::move(k), std::move(v));
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+void PersistentSortedList<Key,Value,Compare,Allocator>::remove(const Key &k)
+{
+	bool removed = false;
+	this->root = removeFrom(this->root, k, removed);
+}
+
+
+#endif
@@ -0,0 +1,538 @@
+#ifndef __SHARDED_SORTED_LIST_HPP
+#define __SHARDED_SORTED_LIST_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "SortedList.hpp"
+
+// A sorted map shared between threads, split by key into shards: each one is a range of keys
+// with its own SortedList and its own reader-writer lock, so writers on different ranges don't wait
+// for each other. Calls about one key (insert, remove, contains, ...) lock only its shard.
+//
+// When a shard grows past maxShardSize keys, it is split in two at its middle key. When one shrinks below
+// a quarter of that, it is merged with its smaller neighbour, if the two fit in one shard, so removing keys
+// doesn't leave behind shards that every call has to skip. Only shards that came from splits are merged:
+// the shards given by the constructor's splitKeys stay, however few keys they hold. Splitting and merging change the list of shards,
+// so they hold every call up while they move the keys of the one or two shards involved.
+//
+// Calls that look at more than one shard (size, getIndex, forEach, ...) lock them one at a time,
+// so with writers running they can see some shards before a change and others after it.
+// Like ConcurrentSortedList, nothing that points into the list is handed out.
+template<typename Key, typename Value, typename Compare = std::less<Key>, typename Allocator = std::allocator<std::pair<const Key, Value>>>
+class ShardedSortedList
+{
+public:
+	using List = SortedList<Key, Value, Compare, Allocator>;
+
+	static constexpr size_t DefaultMaxShardSize = 1 << 14;
+
+	// Starts with one shard, which splits as it grows
+	ShardedSortedList();
+	explicit ShardedSortedList(size_t maxShardSize, const Compare & comp = Compare(), const Allocator & a = Allocator());
+
+	// Starts with splitKeys.size() + 1 shards: keys < splitKeys[0], keys >= splitKeys[0] and < splitKeys[1], ...
+	// These bounds are kept for the life of the list: shards are never merged across them.
+	// splitKeys must be in increasing order with no duplicates; if not, this throws a std::invalid_argument.
+	explicit ShardedSortedList(std::vector<Key> splitKeys, size_t maxShardSize = DefaultMaxShardSize,
+		const Compare & comp = Compare(), const Allocator & a = Allocator());
+
+	ShardedSortedList(const ShardedSortedList &) = delete;
+	ShardedSortedList & operator=(const ShardedSortedList &) = delete;
+
+
+	// the number of keys, added up from every shard's count
+	size_t size() const;
+	bool isEmpty() const;
+
+	// the number of shards there are now
+	size_t shardCount() const;
+
+	// If this key is already present, return false.
+	// otherwise, return true after inserting this key/value pair.
+	bool insert(const Key &k, const Value &v);
+	bool insert(Key &&k, Value &&v);
+
+	// If this key is already present, return false without making a value.
+	// otherwise, return true after inserting this key with a value made from args.
+	template<typename... Args>
+	bool try_emplace(const Key &k, Args&&... args);
+
+	// removes the given key (and its associated value) from the list.
+	// If that key is not in the list, this will silently do nothing.
+	void remove(const Key &k);
+
+	// removes every key that is >= lo and < hi, and returns how many there were.
+	size_t removeRange(const Key &lo, const Key &hi);
+
+	// Return true if this list contains a mapping of this key.
+	bool contains(const Key &k) const;
+
+	// returns a copy of this key's value, or std::nullopt if it is not in the list
+	std::optional<Value> tryGet(const Key &k) const;
+
+	// returns a copy of this key's value.
+	// If this key does not exist in the list, this throws a KeyNotFoundException.
+	Value operator[] (const Key &k) const;
+
+	// If this key exists in the list, this function returns how many keys are in the list that are less than it:
+	// its index in its shard, plus the counts of the shards before it.
+	// If this key does not exist in the list, this throws a KeyNotFoundException.
+	unsigned getIndex(const Key &k) const;
+
+	// returns the largest key in the list that is < the given key,
+	// or the smallest key in the list that is > the given key.
+	// If no such element exists, these throw a KeyNotFoundException.
+	Key largestLessThan(const Key & k) const;
+	Key smallestGreaterThan(const Key & k) const;
+
+	// Calls f(key, value) for every key in order, one shard at a time.
+	// f must not call back into this ShardedSortedList.
+	template<typename F>
+	void forEach(F && f) const;
+
+private:
+	struct Shard
+	{
+		mutable std::shared_mutex mutex;
+		List list;
+		// list.size(), where the calls that add up shards can read it without taking mutex
+		std::atomic<size_t> count;
+
+		Shard(const Compare & comp, const Allocator & a)
+			: list(comp, a), count(0) {}
+	};
+
+	// Keeps a Shard's count up to date once a change to its list is done (before its lock is let go)
+	struct CountUpdate
+	{
+		Shard & shard;
+		~CountUpdate() { shard.count.store(shard.list.size()); }
+	};
+
+	// Locked for reading by every call, and for writing only to change the shards themselves
+	mutable std::shared_mutex shardsMutex;
+	// shards[i] holds the keys that are >= bounds[i - 1] and < bounds[i].
+	// Shards are removed when they are merged, so a Shard* is only good while shardsMutex is held.
+	std::vector<std::unique_ptr<Shard>> shards;
+	std::vector<Key> bounds;
+	// fixed[i] is true if bounds[i] came from splitKeys, so the shards on either side of it are never merged
+	std::vector<bool> fixed;
+	size_t maxShardSize;
+	[[no_unique_address]] Compare compare;
+	[[no_unique_address]] Allocator allocator;
+
+	// the index of the shard k belongs in. shardsMutex must be held.
+	size_t shardOf(const Key & k) const;
+
+	// Runs f(list) on k's shard, locked for reading or writing
+	template<typename F>
+	decltype(auto) readShard(const Key & k, F && f) const;
+	template<typename F>
+	decltype(auto) writeShard(const Key & k, F && f);
+
+	// inserts with f(list), then splits the shard if it has grown too large
+	template<typename F>
+	bool insertWith(const Key & k, F && f);
+
+	// splits k's shard in two at its middle key, if it is still too large once every call is held up
+	void split(const Key & k);
+
+	// true if shard i, holding size keys, is small enough to merge and one of its neighbours has room for it.
+	// shardsMutex must be held.
+	bool canMerge(size_t i, size_t size) const;
+	// true if shard i, holding size keys, and the shard before (or after) it fit in one shard,
+	// and the bound between them came from a split. shardsMutex must be held.
+	bool fitsWithPrevious(size_t i, size_t size) const;
+	bool fitsWithNext(size_t i, size_t size) const;
+	// merges every shard from lo's to hi's that canMerge, once every call is held up
+	void mergeSmall(const Key & lo, const Key & hi);
+	// moves the keys of shard i + 1 into shard i and removes it. shardsMutex must be held for writing.
+	void mergeShards(size_t i);
+};
+
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+ShardedSortedList<Key,Value,Compare,Allocator>::ShardedSortedList()
+	: ShardedSortedList(DefaultMaxShardSize)
+{}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+ShardedSortedList<Key,Value,Compare,Allocator>::ShardedSortedList(size_t maxShardSize, const Compare & comp, const Allocator & a)
+	: ShardedSortedList(std::vector<Key>(), maxShardSize, comp, a)
+{}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+ShardedSortedList<Key,Value,Compare,Allocator>::ShardedSortedList(std::vector<Key> splitKeys, size_t maxShardSize,
+	const Compare & comp, const Allocator & a)
+	: bounds(std::move(splitKeys)), fixed(bounds.size(), true), maxShardSize(std::max<size_t>(maxShardSize, 2)), compare(comp), allocator(a)
+{
+	for (size_t i = 1; i < bounds.size(); i++)
+	{
+		if (! compare(bounds[i - 1], bounds[i]))
+		{
+			throw std::invalid_argument{"Keys are not sorted and unique"};
+		}
+	}
+	for (size_t i = 0; i <= bounds.size(); i++)
+	{
+		shards.push_back(std::make_unique<Shard>(compare, allocator));
+	}
+}
+
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+size_t ShardedSortedList<Key,Value,Compare,Allocator>::shardOf(const Key & k) const
+{
+	auto bound = std::upper_bound(bounds.begin(), bounds.end(), k, [this](const Key & a, const Key & b)
+	{
+		return compare(a, b);
+	});
+	return bound - bounds.begin();
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+template<typename F>
+decltype(auto) ShardedSortedList<Key,Value,Compare,Allocator>::readShard(const Key & k, F && f) const
+{
+	std::shared_lock shardsLock(shardsMutex);
+	const Shard & shard = *shards[shardOf(k)];
+	std::shared_lock lock(shard.mutex);
+	return std::forward<F>(f)(shard.list);
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+template<typename F>
+decltype(auto) ShardedSortedList<Key,Value,Compare,Allocator>::writeShard(const Key & k, F && f)
+{
+	std::shared_lock shardsLock(shardsMutex);
+	Shard & shard = *shards[shardOf(k)];
+	std::unique_lock lock(shard.mutex);
+	CountUpdate update{shard};
+	return std::forward<F>(f)(shard.list);
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+template<typename F>
+bool ShardedSortedList<Key,Value,Compare,Allocator>::insertWith(const Key & k, F && f)
+{
+	bool tooLarge = false;
+	bool inserted = writeShard(k, [&](List & list)
+	{
+		bool added = std::forward<F>(f)(list);
+		tooLarge = list.size() > maxShardSize;
+		return added;
+	});
+	if (tooLarge)
+	{
+		split(k);
+	}
+	return inserted;
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+void ShardedSortedList<Key,Value,Compare,Allocator>::split(const Key & k)
+{
+	std::unique_lock shardsLock(shardsMutex);
+	// Another insert may have split it first
+	size_t i = shardOf(k);
+	Shard* shard = shards[i].get();
+	if (shard->list.size() <= maxShardSize)
+	{
+		return;
+	}
+	// The upper half moves to a new shard after this one, which starts at the middle key
+	List & list = shard->list;
+	Key middle = list.keyAt(static_cast<unsigned>(list.size() / 2));
+	auto upper = std::make_unique<Shard>(compare, allocator);
+	upper->list.assignSorted(list.lowerBound(middle), list.end());
+	while (! list.isEmpty() && ! compare(list.back(), middle))
+	{
+		list.popBack();
+	}
+	shard->count.store(list.size());
+	upper->count.store(upper->list.size());
+	shards.insert(shards.begin() + i + 1, std::move(upper));
+	bounds.insert(bounds.begin() + i, std::move(middle));
+	fixed.insert(fixed.begin() + i, false);
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+bool ShardedSortedList<Key,Value,Compare,Allocator>::canMerge(size_t i, size_t size) const
+{
+	// The neighbours' counts can be read without their locks; mergeSmall checks again with every call held up
+	return size < maxShardSize / 4 && (fitsWithPrevious(i, size) || fitsWithNext(i, size));
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+bool ShardedSortedList<Key,Value,Compare,Allocator>::fitsWithPrevious(size_t i, size_t size) const
+{
+	return i > 0 && ! fixed[i - 1] && shards[i - 1]->count.load() + size <= maxShardSize;
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+bool ShardedSortedList<Key,Value,Compare,Allocator>::fitsWithNext(size_t i, size_t size) const
+{
+	return i + 1 < shards.size() && ! fixed[i] && shards[i + 1]->count.load() + size <= maxShardSize;
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+void ShardedSortedList<Key,Value,Compare,Allocator>::mergeSmall(const Key & lo, const Key & hi)
+{
+	std::unique_lock shardsLock(shardsMutex);
+	for (size_t i = shardOf(lo); i <= shardOf(hi) && i < shards.size();)
+	{
+		if (! canMerge(i, shards[i]->count.load()))
+		{
+			i++;
+			continue;
+		}
+		// Merge into the smaller neighbour (that has room), then look at the merged shard again
+		size_t lower = i;
+		bool left = fitsWithPrevious(i, shards[i]->count.load());
+		bool right = fitsWithNext(i, shards[i]->count.load());
+		if (left && (! right || shards[i - 1]->count.load() <= shards[i + 1]->count.load()))
+		{
+			lower = i - 1;
+		}
+		mergeShards(lower);
+		i = lower;
+	}
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+void ShardedSortedList<Key,Value,Compare,Allocator>::mergeShards(size_t i)
+{
+	// Every key of the lower shard comes before every key of the upper one, so each moved key goes in
+	// at one end of the other list, which a hinted insert finds without a search. The smaller list is moved.
+	List & lower = shards[i]->list;
+	List & upper = shards[i + 1]->list;
+	if (lower.size() >= upper.size())
+	{
+		for (auto & entry : upper)
+		{
+			lower.emplace_hint(lower.cend(), entry.key, std::move(entry.value));
+		}
+	}
+	else
+	{
+		auto front = upper.cbegin();
+		for (auto & entry : lower)
+		{
+			upper.emplace_hint(front, entry.key, std::move(entry.value));
+		}
+		lower.swap(upper);
+	}
+	shards[i]->count.store(lower.size());
+	shards.erase(shards.begin() + i + 1);
+	bounds.erase(bounds.begin() + i);
+	fixed.erase(fixed.begin() + i);
+}
+
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+size_t ShardedSortedList<Key,Value,Compare,Allocator>::size() const
+{
+	std::shared_lock shardsLock(shardsMutex);
+	size_t total = 0;
+	for (const std::unique_ptr<Shard> & shard : shards)
+	{
+		total += shard->count.load();
+	}
+	return total;
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+bool ShardedSortedList<Key,Value,Compare,Allocator>::isEmpty() const
+{
+	return size() == 0;
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+size_t ShardedSortedList<Key,Value,Compare,Allocator>::shardCount() const
+{
+	std::shared_lock shardsLock(shardsMutex);
+	return shards.size();
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+bool ShardedSortedList<Key,Value,Compare,Allocator>::insert(const Key &k, const Value &v)
+{
+	return insertWith(k, [&](List & list)
+	{
+		return list.insert(k, v);
+	});
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+bool ShardedSortedList<Key,Value,Compare,Allocator>::insert(Key &&k, Value &&v)
+{
+	return insertWith(k, [&](List & list)
+	{
+		return list.insert(std::move(k), std::move(v));
+	});
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+template<typename... Args>
+bool ShardedSortedList<Key,Value,Compare,Allocator>::try_emplace(const Key &k, Args&&... args)
+{
+	return insertWith(k, [&](List & list)
+	{
+		return list.try_emplace(k, std::forward<Args>(args)...);
+	});
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+void ShardedSortedList<Key,Value,Compare,Allocator>::remove(const Key &k)
+{
+	bool small = writeShard(k, [&](List & list)
+	{
+		// Only a remove that found its key can have made the shard small enough to merge
+		size_t before = list.size();
+		list.remove(k);
+		return list.size() < before && canMerge(shardOf(k), list.size());
+	});
+	if (small)
+	{
+		mergeSmall(k, k);
+	}
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+size_t ShardedSortedList<Key,Value,Compare,Allocator>::removeRange(const Key &lo, const Key &hi)
+{
+	if (! compare(lo, hi))
+	{
+		return 0;
+	}
+	size_t removed = 0;
+	bool small = false;
+	{
+		std::shared_lock shardsLock(shardsMutex);
+		for (size_t i = shardOf(lo), last = shardOf(hi); i <= last; i++)
+		{
+			Shard & shard = *shards[i];
+			std::unique_lock lock(shard.mutex);
+			CountUpdate update{shard};
+			size_t removedHere = shard.list.removeRange(lo, hi);
+			removed += removedHere;
+			small = small || (removedHere > 0 && canMerge(i, shard.list.size()));
+		}
+	}
+	if (small)
+	{
+		mergeSmall(lo, hi);
+	}
+	return removed;
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+bool ShardedSortedList<Key,Value,Compare,Allocator>::contains(const Key &k) const
+{
+	return readShard(k, [&](const List & list)
+	{
+		return list.contains(k);
+	});
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+std::optional<Value> ShardedSortedList<Key,Value,Compare,Allocator>::tryGet(const Key &k) const
+{
+	return readShard(k, [&](const List & list) -> std::optional<Value>
+	{
+		// Copy the value while the lock still keeps its Node in the list
+		if (const Value* value = list.tryGet(k))
+		{
+			return *value;
+		}
+		return std::nullopt;
+	});
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+Value ShardedSortedList<Key,Value,Compare,Allocator>::operator[] (const Key &k) const
+{
+	return readShard(k, [&](const List & list) -> Value
+	{
+		return list[k];
+	});
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+unsigned ShardedSortedList<Key,Value,Compare,Allocator>::getIndex(const Key &k) const
+{
+	std::shared_lock shardsLock(shardsMutex);
+	size_t i = shardOf(k);
+	unsigned index;
+	{
+		std::shared_lock lock(shards[i]->mutex);
+		index = shards[i]->list.getIndex(k);
+	}
+	for (size_t j = 0; j < i; j++)
+	{
+		index += static_cast<unsigned>(shards[j]->count.load());
+	}
+	return index;
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+Key ShardedSortedList<Key,Value,Compare,Allocator>::largestLessThan(const Key & k) const
+{
+	std::shared_lock shardsLock(shardsMutex);
+	// Look in k's shard, then in the last key of each shard before it
+	for (size_t i = shardOf(k) + 1; i-- > 0;)
+	{
+		const Shard & shard = *shards[i];
+		std::shared_lock lock(shard.mutex);
+		auto it = shard.list.lowerBound(k);
+		if (it != shard.list.begin())
+		{
+			return std::prev(it)->key;
+		}
+	}
+	throw KeyNotFoundException{"Key not found in list"};
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+Key ShardedSortedList<Key,Value,Compare,Allocator>::smallestGreaterThan(const Key & k) const
+{
+	std::shared_lock shardsLock(shardsMutex);
+	// Look in k's shard, then in the first key of each shard after it
+	for (size_t i = shardOf(k); i < shards.size(); i++)
+	{
+		const Shard & shard = *shards[i];
+		std::shared_lock lock(shard.mutex);
+		auto it = shard.list.upperBound(k);
+		if (it != shard.list.end())
+		{
+			return it->key;
+		}
+	}
+	throw KeyNotFoundException{"Key not found in list"};
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+template<typename F>
+void ShardedSortedList<Key,Value,Compare,Allocator>::forEach(F && f) const
+{
+	std::shared_lock shardsLock(shardsMutex);
+	for (const std::unique_ptr<Shard> & shard : shards)
+	{
+		std::shared_lock lock(shard->mutex);
+		for (const auto & [key, value] : shard->list)
+		{
+			f(key, value);
+		}
+	}
+}
+
+
+#endif
@@ -1,7 +1,21 @@
 #ifndef __SORTED_DOUBLY_LINKED_LIST_HPP
 #define __SORTED_DOUBLY_LINKED_LIST_HPP
 
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <iterator>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <ranges>
 #include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "NodePool.hpp"
 
 class KeyNotFoundException : public std::runtime_error 
 {
@@ -9,25 +23,275 @@ public:
 	explicit KeyNotFoundException(const std::string & err) : std::runtime_error(err) {}
 };
 
-template<typename Key, typename Value>
+// A Compare that can compare keys with other types, such as std::less<>, says so with an is_transparent member.
+// Then a key can be looked up by anything it can be compared with, without making a Key from it.
+template<typename Compare>
+concept TransparentCompare = requires { typename Compare::is_transparent; };
+
+// Keys are kept in the order given by Compare, as in std::map: compare(a, b) is true if a comes before b,
+// and two keys are the same key if neither comes before the other.
+// Allocator is used for all the memory of the list. Nodes are taken from it in slabs
+// by a NodePool, so most inserts and removes don't call it at all.
+//
+// Copies are copy-on-write: a copy shares the Nodes of the list it was copied from, so copying is O(1),
+// and each list gets its own Nodes the first time it is changed while they are shared, which copies them
+// all in O(n). Anything that could change a list counts, including handing out an iterator or a reference
+// to a value that isn't const (begin, end, find, operator[], ...), so on a list that shares its Nodes even
+// a non-const lookup costs O(n) once; const lookups never copy. Iterators and references into a list that
+// shares its Nodes stop being valid once it gets its own.
+// Once a list has handed out such an iterator or reference, something outside it can change its Nodes,
+// so from then on its copies are deep copies (O(n)) that don't share them.
+template<typename Key, typename Value, typename Compare = std::less<Key>, typename Allocator = std::allocator<std::pair<const Key, Value>>>
 class SortedList
 {
-private:
-	// make the doubly linked list
-	struct Node
+public:
+	// a key and its value, as seen through an iterator. The key can't be changed once it is in the list.
+	struct Entry
 	{
-		Key key;
+		const Key key;
 		Value value;
+
+		// the key is made from k and the value from args, as in try_emplace
+		template<typename K, typename... Args>
+			requires (! std::is_same_v<std::remove_cvref_t<K>, std::piecewise_construct_t>)
+		Entry(K&& k, Args&&... args)
+			: key(std::forward<K>(k)), value(std::forward<Args>(args)...) {}
+
+		// the key and value are each made from a tuple of arguments, as in std::pair
+		template<typename... KeyArgs, typename... ValueArgs>
+		Entry(std::piecewise_construct_t, std::tuple<KeyArgs...> k, std::tuple<ValueArgs...> v)
+			: key(std::make_from_tuple<Key>(std::move(k))), value(std::make_from_tuple<Value>(std::move(v))) {}
+	};
+
+private:
+	// Maximum number of levels a Node can be linked into (level 0 is the doubly linked list itself).
+	// Each level holds about a quarter of the Nodes of the level below it,
+	// so this is plenty for any list that fits in memory.
+	static constexpr unsigned MaxLevel = 24;
+	// How far a hinted insert walks from its hint before giving up and searching the index,
+	// so a bad hint costs only a few comparisons more than no hint at all
+	static constexpr unsigned MaxHintSteps = 8;
+
+	struct Node;
+
+	// one level of the skip-list index above the doubly linked list.
+	// A nullptr prev means the head of the list, a nullptr next means the end of the list.
+	// span is how many level-0 steps the link jumps over, counting the end of the list as one
+	// past the tail, so ranks can be added up while searching.
+	struct Link
+	{
 		Node* prev;
 		Node* next;
+		size_t span;
+	};
 
-		Node(const Key& k, const Value& v) : key(k), value(v), prev(nullptr), next(nullptr) {}
+	// make the doubly linked list (the key and value are in the Entry)
+	struct Node : Entry
+	{
+		Node* prev;
+		Node* next;
+		// number of levels this Node is linked into, counting level 0 (prev/next)
+		unsigned height;
+		// links for levels 1 .. height - 1, or nullptr for a Node that is only on level 0
+		Link* tower;
+
+		// the Entry is made from args
+		template<typename... Args>
+		Node(unsigned h, Link* t, Args&&... args)
+			: Entry(std::forward<Args>(args)...), prev(nullptr), next(nullptr), height(h), tower(t) {}
+
+		Node(const Node &) = delete;
+		Node & operator=(const Node &) = delete;
 	};
 
 	Node* head;
+	// last Node of the list, so the largest key can be reached without walking from head
+	Node* tail;
+	// number of Nodes in the list, kept up to date so size() does not have to walk it
+	size_t count;
+
+	// Skip-list index on top of the doubly linked list: the head's links for levels 1 .. MaxLevel - 1,
+	// and how many levels (including level 0) are currently in use.
+	Link headLinks[MaxLevel - 1];
+	unsigned levels;
+	// state of the generator that picks the height of new Nodes
+	std::uint64_t heightSeed;
+	// the order of the keys
+	[[no_unique_address]] Compare compare;
+
+	// where Nodes and their towers come from. Lists that were copied from each other share one Storage,
+	// whose Nodes none of them change until it has them to itself; the last one to let go deletes them.
+	using LinkAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Link>;
+	using LinkTraits = std::allocator_traits<LinkAllocator>;
+	struct Storage
+	{
+		NodePool<Node, Allocator> nodePool;
+		[[no_unique_address]] LinkAllocator linkAllocator;
+		// how many lists are using these Nodes
+		std::atomic<size_t> owners;
+
+		explicit Storage(const Allocator & a)
+			: nodePool(a), linkAllocator(a), owners(1) {}
+	};
+	using StorageAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Storage>;
+	using StorageTraits = std::allocator_traits<StorageAllocator>;
+	// nullptr until the list makes its first Node
+	Storage* storage;
+	// true once an iterator or reference that can change this list's Nodes has been handed out.
+	// Such a list never shares its Nodes, so a change made through one can't show up in a copy.
+	bool exposed;
+	[[no_unique_address]] Allocator allocator;
+
+	// the last Node before some position on every level in use (nullptr for the head),
+	// and the rank of each of them: how many Nodes come before it, plus one (the head's rank is 0)
+	struct Path
+	{
+		Node* update[MaxLevel];
+		size_t rank[MaxLevel];
+	};
+
+
+	// picks a height for a new Node: 1 with probability 3/4, 2 with probability 3/16, ...
+	unsigned randomHeight() noexcept;
+
+	// makes a Node (and its tower) in the list's memory from args, or destroys one and gives its memory back
+	template<typename... Args>
+	Node* createNode(unsigned height, Args&&... args);
+	void destroyNode(Node* n) noexcept;
+
+	// follows a Node's links on the given level. A nullptr Node stands for the head of the list;
+	// setPrev with a nullptr Node on level 0 sets the tail.
+	Node* nextAt(Node* x, unsigned level) const noexcept;
+	Node* prevAt(Node* x, unsigned level) const noexcept;
+	void setNext(Node* x, unsigned level, Node* n) noexcept;
+	void setPrev(Node* x, unsigned level, Node* p) noexcept;
+	// the span of a Node's link on the given level (which must be above 0)
+	size_t & spanAt(Node* x, unsigned level) noexcept;
+	size_t spanAt(Node* x, unsigned level) const noexcept;
+
+	// Every search walks the keys in order and stops at the first one that doesn't come before k,
+	// so a key that isn't in the list costs no more to look for than one that is.
+	// returns the last Node whose key is < k (nullptr if there is none).
+	// If path is given, it is filled with the last such Node on every level in use.
+	// k is a Key, or anything that can be compared with one if Compare is transparent.
+	template<typename K>
+	Node* findPredecessor(const K & k, Path* path = nullptr) const;
+	// returns the Node with this key, or nullptr if there is none
+	template<typename K>
+	Node* findNode(const K & k) const;
+	// returns the Node with this rank, or nullptr if rank is 0 or more than size()
+	Node* findRank(size_t rank) const noexcept;
+	// return the first Node whose key is >= k (lower bound) or > k (upper bound),
+	// and the last Node whose key is <= k (floor), or nullptr if there is none
+	Node* findLowerBound(const Key & k) const;
+	Node* findUpperBound(const Key & k) const;
+	Node* findFloor(const Key & k) const;
+	// fills path with the Nodes that a new Node with key k would follow on every level.
+	// Returns false if k is already in the list; then only path.update[0] is filled, with the Node before k's.
+	bool findInsertPath(const Key & k, Path & path) const;
+	// the same, but path already holds the place of some key less than k, and is moved on from there.
+	// Only the levels whose links jump past keys less than k are searched again, so a key close
+	// to the last one is found in a few steps.
+	bool advanceInsertPath(const Key & k, Path & path) const;
+	// the same, but looks for k's place by walking outward from hint (nullptr for the end of the list)
+	// before falling back to searching the index
+	bool findInsertPathNear(Node* hint, const Key & k, Path & path) const;
+	// inserts a Node made from k and args if k isn't in the list yet, and returns whether it did
+	template<typename K, typename... Args>
+	bool insertIfAbsent(K&& k, Args&&... args);
+	// the same, starting from hint, but returns the Node with k (whether it is new or not)
+	template<typename K, typename... Args>
+	Node* insertNear(Node* hint, K&& k, Args&&... args);
+	// fills from and to with the Nodes before lo and before hi on every level, for a range [lo, hi).
+	// Returns false (and fills neither) if lo is not less than hi.
+	bool findRangePaths(const Key & lo, const Key & hi, Path & from, Path & to) const;
+	// fills path with the Nodes that a new Node placed right after x (nullptr for the head) would follow on every level
+	void predecessorsOf(Node* x, Path & path) const noexcept;
+
+	// links n into every level of the list after the Nodes in path, and counts it
+	void linkNode(Node* n, Path & path) noexcept;
+	// unlinks n from every level of the list and uncounts it (but does not delete it).
+	// If path is given, it holds the Nodes before n on every level, so they don't have to be looked for.
+	void unlinkNode(Node* n, const Path* path = nullptr) noexcept;
+	// stops searching levels that no longer have any Nodes
+	void dropEmptyLevels() noexcept;
+
+	// makes a Node of the given height from args and links it in where path says it goes.
+	// path is then updated to say where a Node right after the new one goes.
+	template<typename... Args>
+	void placeNode(Path & path, unsigned height, Args&&... args);
+	// deep copies every Node of st into this (empty) list
+	void copyNodes(const SortedList & st);
+	// makes this (empty) list share st's Nodes
+	void shareNodes(const SortedList & st) noexcept;
+	// gives this list Nodes of its own, copying them if another list shares them, before they are changed.
+	// returns true if they were copied (so any Node* taken before now is not in this list any more).
+	bool unshare();
+	// unshares, then marks the list as exposed, before handing out something that can change its Nodes
+	bool exposeNodes();
+	// lets go of every Node, deleting them unless another list shares them, and leaves the list empty
+	void releaseNodes() noexcept;
+	// deletes every Node, which no other list may share
+	void deleteNodes() noexcept;
+	// forgets every Node without deleting them (after they have been handed to another list)
+	void resetNodes() noexcept;
+
+
+	// walks the Nodes in order using next, or backwards using prev
+	template<bool Const>
+	class Iterator
+	{
+	public:
+		using iterator_category = std::bidirectional_iterator_tag;
+		using value_type = Entry;
+		using difference_type = std::ptrdiff_t;
+		using pointer = std::conditional_t<Const, const Entry*, Entry*>;
+		using reference = std::conditional_t<Const, const Entry&, Entry&>;
+
+		Iterator() noexcept : list(nullptr), node(nullptr) {}
+		Iterator(const SortedList* l, Node* n) noexcept : list(l), node(n) {}
+		// an iterator can always be turned into a const_iterator
+		operator Iterator<true>() const noexcept { return Iterator<true>(list, node); }
+
+		reference operator*() const noexcept { return *node; }
+		pointer operator->() const noexcept { return node; }
+
+		Iterator & operator++() noexcept { node = node->next; return *this; }
+		Iterator operator++(int) noexcept { Iterator old = *this; node = node->next; return old; }
+		// Moving back from the end goes to the tail
+		Iterator & operator--() noexcept { node = node != nullptr ? node->prev : list->tail; return *this; }
+		Iterator operator--(int) noexcept { Iterator old = *this; --*this; return old; }
+
+		bool operator==(const Iterator & other) const noexcept { return node == other.node; }
+
+	private:
+		friend class SortedList;
+
+		const SortedList* list;
+		Node* node;
+	};
 
 public:
+	using key_type = Key;
+	using mapped_type = Value;
+	using value_type = Entry;
+	using iterator = Iterator<false>;
+	using const_iterator = Iterator<true>;
+	using reverse_iterator = std::reverse_iterator<iterator>;
+	using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
 	SortedList();
+	explicit SortedList(const Compare & comp, const Allocator & a = Allocator());
+	explicit SortedList(const Allocator & a);
+
+	// Makes a list of the key/value pairs in [first, last) (std::pairs, or the entries of another list).
+	// Pairs that come in increasing order are linked straight on after the tail without a search,
+	// so a sorted range is loaded in O(n). Any that are out of order are inserted as insert would,
+	// and duplicates are skipped.
+	template<std::input_iterator InputIt>
+	SortedList(InputIt first, InputIt last, const Compare & comp = Compare(), const Allocator & a = Allocator());
+	template<std::input_iterator InputIt>
+	SortedList(InputIt first, InputIt last, const Allocator & a);
 
 	// Note:  copy constructors are required.
 	// Be sure to do a "deep copy" -- if I 
@@ -36,26 +300,142 @@ public:
 	SortedList & operator=(const SortedList & st);
 	~SortedList();
 
+	// Moving a list hands its Nodes (and the memory they are in) to the new list without copying any,
+	// and leaves the old list empty.
+	SortedList(SortedList && st) noexcept;
+	SortedList & operator=(SortedList && st) noexcept;
+
+	// trades the contents of the two lists without copying any Nodes
+	void swap(SortedList & other) noexcept;
+	friend void swap(SortedList & a, SortedList & b) noexcept
+	{
+		a.swap(b);
+	}
+
+	// returns a copy of the allocator the list's memory comes from
+	Allocator get_allocator() const noexcept;
+	// returns a copy of the comparison that orders the keys
+	Compare key_comp() const;
+
 
 	size_t size() const noexcept;
 	bool isEmpty() const noexcept;
 
 
+	// returns the smallest (front) or largest (back) key in the list.
+	// If the list is empty, this throws a KeyNotFoundException.
+	const Key & front() const;
+	const Key & back() const;
+
+	// removes the smallest (front) or largest (back) key and its value from the list.
+	// If the list is empty, this will silently do nothing.
+	void popFront();
+	void popBack();
+
+
 	// If this key is already present, return false.
 	// otherwise, return true after inserting this key/value pair.
 	bool insert(const Key &k, const Value &v); 
+	// The same, but the key and value are moved into the list instead of copied.
+	bool insert(Key &&k, Value &&v);
+
+	// Makes a key/value pair from args in place, as std::map::emplace does:
+	// emplace(k, v) or emplace(std::piecewise_construct, keyArgs, valueArgs).
+	// If that key is already present, the pair is thrown away and this returns false.
+	template<typename... Args>
+	bool emplace(Args&&... args);
+
+	// If this key is already present, return false without making a value.
+	// otherwise, return true after inserting this key with a value made from args.
+	template<typename... Args>
+	bool try_emplace(const Key &k, Args&&... args);
+	template<typename... Args>
+	bool try_emplace(Key &&k, Args&&... args);
+
+	// Inserts like insert and emplace, but the search starts at hint instead of at the front of the list,
+	// as std::map::emplace_hint does. If the key belongs just before hint (or a few Nodes away from it),
+	// finding its place takes a few comparisons instead of a search, so inserting keys next to the last
+	// one inserted is cheap. Returns an iterator to the key, whether it was inserted or already present.
+	iterator insert(const_iterator hint, const Key &k, const Value &v);
+	iterator insert(const_iterator hint, Key &&k, Value &&v);
+	template<typename... Args>
+	iterator emplace_hint(const_iterator hint, Args&&... args);
+
+	// Replaces everything in the list with the key/value pairs in [first, last) in O(n).
+	// The keys must be in increasing order with no duplicates; if they are not,
+	// this throws a std::invalid_argument and leaves the list as it was.
+	template<std::input_iterator InputIt>
+	void assignSorted(InputIt first, InputIt last);
+
+	// Inserts every key/value pair of batch (std::pairs, in any order) that isn't in the list yet.
+	// The batch is sorted and then merged into the list in one walk from front to back, where each key's
+	// place is found by stepping on from the last one's instead of searching from the front.
+	// Returns, for each pair in the order of batch, whether it was inserted (true) or its key was
+	// already present (false). If a key appears more than once in batch, only its first pair is inserted.
+	template<std::ranges::forward_range Batch>
+	std::vector<bool> insertBatch(Batch && batch);
 
 	// Return true if this SortedList contains a mapping of this key.
 	bool contains(const Key &k) const noexcept; 
 
+	// returns an iterator to this key, or end() if it is not in the list
+	iterator find(const Key &k);
+	const_iterator find(const Key &k) const;
+
+	// returns a pointer to this key's value, or nullptr if it is not in the list.
+	// Unlike operator[], a missing key costs only the search.
+	Value* tryGet(const Key &k);
+	const Value* tryGet(const Key &k) const;
+
+	// If Compare is transparent, contains, find, tryGet and operator[] also take anything that
+	// Compare can compare with a Key (a std::string_view or const char* for std::string keys),
+	// as std::map's do, and compare it with the keys as it is instead of making a Key from it.
+	template<typename K> requires TransparentCompare<Compare>
+	bool contains(const K &k) const noexcept;
+	template<typename K> requires TransparentCompare<Compare>
+	iterator find(const K &k);
+	template<typename K> requires TransparentCompare<Compare>
+	const_iterator find(const K &k) const;
+	template<typename K> requires TransparentCompare<Compare>
+	Value* tryGet(const K &k);
+	template<typename K> requires TransparentCompare<Compare>
+	const Value* tryGet(const K &k) const;
+	template<typename K> requires TransparentCompare<Compare>
+	Value & operator[] (const K &k);
+	template<typename K> requires TransparentCompare<Compare>
+	const Value & operator[] (const K &k) const;
+
 
 	// removes the given key (and its associated value) from the list.
 	// If that key is not in the list, this will silently do nothing.
 	void remove(const Key &k);
 
+	// removes every key that is >= lo and < hi, and returns how many there were.
+	// The run of Nodes is cut out of every level at once, so this takes O(log n) plus O(1) per key removed.
+	size_t removeRange(const Key &lo, const Key &hi);
+
+	// removes every key/value pair for which pred(entry) is true in one walk over the list,
+	// and returns how many there were
+	template<typename Pred>
+	size_t removeIf(Pred pred);
+
+	// removes each of keys (where present), and returns how many were removed.
+	// Each key is looked for starting from where the one before it was, so keys in increasing
+	// order are removed in one pass; keys in any other order still work, just more slowly.
+	template<std::ranges::input_range Keys>
+	size_t removeBatch(const Keys & keys);
+
 	// If this key exists in the list, this function returns how many keys are in the list that are less than it.
 	// If this key does not exist in the list, this throws a KeyNotFoundException.
 	unsigned getIndex(const Key &k) const;
+	// The same, but returns std::nullopt instead of throwing if the key is not in the list.
+	std::optional<unsigned> tryGetIndex(const Key &k) const;
+
+	// returns the key, or the value, that has this index (the reverse of getIndex).
+	// If the index is not less than size(), this throws a std::out_of_range.
+	const Key & keyAt(unsigned i) const;
+	Value & atIndex(unsigned i);
+	const Value & atIndex(unsigned i) const;
 
 	// If this key does not exist in the list, this throws a KeyNotFoundException.
 	// subscript operator for non-const objects returns modifiable lvalue
@@ -95,7 +475,34 @@ public:
 	// There's no prize for "first to finish this function."  Write the previous one first.
 	const Key & smallestGreaterThan(const Key & k) const;
 
-	
+
+	// Searches like the ones above, but they return an iterator, which is end() if there is no such key,
+	// instead of throwing. Each is one search of the index.
+	// lowerBound and ceiling: the smallest key >= k (they are the same thing).
+	// upperBound: the smallest key > k.
+	// floor: the largest key <= k.
+	// equalRange: lowerBound and upperBound together, which surround k if it is in the list.
+	iterator lowerBound(const Key & k);
+	const_iterator lowerBound(const Key & k) const;
+	iterator upperBound(const Key & k);
+	const_iterator upperBound(const Key & k) const;
+	iterator floor(const Key & k);
+	const_iterator floor(const Key & k) const;
+	iterator ceiling(const Key & k);
+	const_iterator ceiling(const Key & k) const;
+	std::pair<iterator, iterator> equalRange(const Key & k);
+	std::pair<const_iterator, const_iterator> equalRange(const Key & k) const;
+
+	// the keys that are >= lo and < hi, as a view that can be walked with range-for.
+	// The view is just the iterators at each end, found with one search of the index
+	// (and a short one on from there), so nothing is copied. It is empty if lo is not less than hi.
+	std::ranges::subrange<iterator> range(const Key & lo, const Key & hi);
+	std::ranges::subrange<const_iterator> range(const Key & lo, const Key & hi) const;
+
+	// returns how many keys are >= lo and < hi, from the ranks of the two ends, in O(log n)
+	size_t countRange(const Key & lo, const Key & hi) const;
+
+
 	// Two SortedLists are equal if and only if:
 	//	* They have the same number of elements
 	//	* Each element matches in both key and value.
@@ -114,385 +521,1580 @@ public:
 	void operator++();
 
 
+	// iterators over the keys and values in order. *it is an Entry with a key and a value;
+	// the value can be changed through an iterator (but not a const_iterator), the key can't.
+	// Iterators stay valid until the Node they are at is removed,
+	// or until the list gets Nodes of its own after being copied (see the top of the class).
+	// The non-const ones give the list its own Nodes first, and stop its copies from sharing them.
+	iterator begin();
+	iterator end();
+	const_iterator begin() const noexcept;
+	const_iterator end() const noexcept;
+	const_iterator cbegin() const noexcept;
+	const_iterator cend() const noexcept;
+	reverse_iterator rbegin();
+	reverse_iterator rend();
+	const_reverse_iterator rbegin() const noexcept;
+	const_reverse_iterator rend() const noexcept;
+	const_reverse_iterator crbegin() const noexcept;
+	const_reverse_iterator crend() const noexcept;
 };
 
 
-template<typename Key, typename Value>
-SortedList<Key,Value>::SortedList() : head(nullptr)
-{}
-
+template<typename Key, typename Value, typename Compare, typename Allocator>
+unsigned SortedList<Key,Value,Compare,Allocator>::randomHeight() noexcept
+{
+	// Advance the xorshift generator
+	heightSeed ^= heightSeed << 13;
+	heightSeed ^= heightSeed >> 7;
+	heightSeed ^= heightSeed << 17;
+	// Every pair of low zero bits (probability 1/4) adds a level
+	unsigned height = 1 + std::countr_zero(heightSeed) / 2;
+	return height < MaxLevel ? height : MaxLevel;
+}
 
-template<typename Key, typename Value>
-SortedList<Key,Value>::SortedList(const SortedList & st) : head(nullptr)
+template<typename Key, typename Value, typename Compare, typename Allocator>
+template<typename... Args>
+typename SortedList<Key,Value,Compare,Allocator>::Node* SortedList<Key,Value,Compare,Allocator>::createNode(unsigned height, Args&&... args)
 {
-	// SortedList l1 = l2
-	// Initialize Node pointer
-	Node* current = st.head;
-	Node* tail = nullptr;
-	// Loop through all the Nodes
-	while (current != nullptr)
+	if (storage == nullptr)
+	{
+		StorageAllocator storageAllocator(allocator);
+		storage = StorageTraits::allocate(storageAllocator, 1);
+		std::construct_at(storage, allocator);
+	}
+	// Level 0 is part of the Node, the rest of its levels are in a separate tower
+	Link* tower = height > 1 ? LinkTraits::allocate(storage->linkAllocator, height - 1) : nullptr;
+	Node* n = nullptr;
+	try
+	{
+		n = storage->nodePool.allocate();
+		std::construct_at(n, height, tower, std::forward<Args>(args)...);
+	}
+	catch (...)
 	{
-		// Initialize a newNode
-		Node* newNode = new Node(current->key, current->value);
-		// Check if head is null, then set newNode to it
-		if (head == nullptr)
+		// Give back whatever was taken before copying the key or value failed
+		if (n != nullptr)
 		{
-			head = newNode;
-			tail = newNode;
+			storage->nodePool.deallocate(n);
 		}
-		// If not, increment the newNode (it is already in order)
-		else
+		if (tower != nullptr)
 		{
-			tail->next = newNode;
-			newNode->prev = tail;
-			tail = newNode;
+			LinkTraits::deallocate(storage->linkAllocator, tower, height - 1);
 		}
-		// Increment Node
-		current = current->next;
+		throw;
 	}
+	return n;
 }
 
-
-template<typename Key, typename Value>
-SortedList<Key,Value> & SortedList<Key,Value>::operator=(const SortedList & st)
+template<typename Key, typename Value, typename Compare, typename Allocator>
+void SortedList<Key,Value,Compare,Allocator>::destroyNode(Node* n) noexcept
 {
-	// l1 = l2
-	if ( this != &st )
+	if (n->tower != nullptr)
 	{
-		// Loop through all the Nodes in SortedList and delete them
-		while (head != nullptr)
-		{
-			Node* current = head;
-			head = head->next;
-			delete current;
-		}
-		// Copy st into given SortedList
-		Node* current = st.head;
-		Node* tail = nullptr;
-		// Loop through Nodes in st and add to SortedList
-		while (current != nullptr)
-		{
-			Node* newNode = new Node(current->key, current->value);
-			// If the st is empty, set newNode as head and tail
-			if (head == nullptr)
-			{
-				head = newNode;
-				tail = newNode;
-			}
-			// If not, increment the newNode (it is already in order)
-			else
-			{
-				tail->next = newNode;
-				newNode->prev = tail;
-				tail = newNode;
-			}
-			// Increment node
-			current = current->next;
-		}
+		LinkTraits::deallocate(storage->linkAllocator, n->tower, n->height - 1);
 	}
-	return *this;
+	std::destroy_at(n);
+	storage->nodePool.deallocate(n);
 }
 
-template<typename Key, typename Value>
-SortedList<Key,Value>::~SortedList()
+template<typename Key, typename Value, typename Compare, typename Allocator>
+typename SortedList<Key,Value,Compare,Allocator>::Node* SortedList<Key,Value,Compare,Allocator>::nextAt(Node* x, unsigned level) const noexcept
 {
-	// Loop through every Node and delete it
-	while(head != nullptr)
+	// Level 0 is the doubly linked list, the other levels are in the towers
+	if (level == 0)
 	{
-		Node* current = head;
-		head = head->next;
-		delete current;
+		return x != nullptr ? x->next : head;
 	}
+	return x != nullptr ? x->tower[level - 1].next : headLinks[level - 1].next;
 }
 
+template<typename Key, typename Value, typename Compare, typename Allocator>
+typename SortedList<Key,Value,Compare,Allocator>::Node* SortedList<Key,Value,Compare,Allocator>::prevAt(Node* x, unsigned level) const noexcept
+{
+	return level == 0 ? x->prev : x->tower[level - 1].prev;
+}
 
-template<typename Key, typename Value>
-size_t SortedList<Key,Value>::size() const noexcept
+template<typename Key, typename Value, typename Compare, typename Allocator>
+void SortedList<Key,Value,Compare,Allocator>::setNext(Node* x, unsigned level, Node* n) noexcept
 {
-	// Initialize size counter and Node pointer holder
-	size_t counter = 0;
-	Node * tmp = head;
-	// Loop through every Node and count it
-	while (tmp != nullptr)
+	if (level == 0)
+	{
+		(x != nullptr ? x->next : head) = n;
+	}
+	else
 	{
-		counter ++;
-		tmp = tmp -> next;
+		(x != nullptr ? x->tower[level - 1].next : headLinks[level - 1].next) = n;
 	}
-	return counter;
 }
 
-template<typename Key, typename Value>
-bool SortedList<Key,Value>::isEmpty() const noexcept
+template<typename Key, typename Value, typename Compare, typename Allocator>
+void SortedList<Key,Value,Compare,Allocator>::setPrev(Node* x, unsigned level, Node* p) noexcept
 {
-	// If there is no Nodes, return true. Else return false.
-	if (head == nullptr)
+	if (x != nullptr)
 	{
-		return true;
+		(level == 0 ? x->prev : x->tower[level - 1].prev) = p;
+	}
+	// The end of level 0 is the tail; the other levels don't keep one
+	else if (level == 0)
+	{
+		tail = p;
 	}
-	return false;
 }
 
+template<typename Key, typename Value, typename Compare, typename Allocator>
+size_t & SortedList<Key,Value,Compare,Allocator>::spanAt(Node* x, unsigned level) noexcept
+{
+	return x != nullptr ? x->tower[level - 1].span : headLinks[level - 1].span;
+}
 
-// If this key is already present, return false.
-// otherwise, return true after inserting this key/value pair/.
-template<typename Key, typename Value>
-bool SortedList<Key,Value>::insert(const Key &k, const Value &v)
+template<typename Key, typename Value, typename Compare, typename Allocator>
+size_t SortedList<Key,Value,Compare,Allocator>::spanAt(Node* x, unsigned level) const noexcept
 {
-	// Make a new Node
-	Node* newNode = new Node(k, v);
+	return x != nullptr ? x->tower[level - 1].span : headLinks[level - 1].span;
+}
 
-	// If the head is null or the new key is less then the key of the current Node, new Node is inserted at the beginning of the list
-	if (head == nullptr || k < head->key)
+template<typename Key, typename Value, typename Compare, typename Allocator>
+template<typename K>
+typename SortedList<Key,Value,Compare,Allocator>::Node* SortedList<Key,Value,Compare,Allocator>::findPredecessor(const K & k, Path* path) const
+{
+	// Start at the head on the highest level in use
+	Node* current = nullptr;
+	size_t rank = 0;
+	for (unsigned level = levels; level-- > 0;)
 	{
-		// Set the next Node to head and see if it exists
-		newNode->next = head;
-		// If it does, set its previous to newNode and make it the new head no matter what
-		if (head != nullptr)
+		// Move forward on this level while the next key is still less than k, then drop down a level
+		Node* next = nextAt(current, level);
+		while (next != nullptr && compare(next->key, k))
 		{
-			head->prev = newNode;
+			rank += level == 0 ? 1 : spanAt(current, level);
+			current = next;
+			next = nextAt(current, level);
+		}
+		if (path != nullptr)
+		{
+			path->update[level] = current;
+			path->rank[level] = rank;
 		}
-		head = newNode;
-		return true;
 	}
+	return current;
+}
 
-	// If the head is not null or the k is greater than current key, loop through doubly linked list to find correct position based on key
-	Node* current = head;
-	// Loop until go through all nodes or the current k is > k
-	while (current->next != nullptr && current->next->key < k)
+template<typename Key, typename Value, typename Compare, typename Allocator>
+template<typename K>
+typename SortedList<Key,Value,Compare,Allocator>::Node* SortedList<Key,Value,Compare,Allocator>::findNode(const K & k) const
+{
+	// The Node with key k, if there is one, comes right after the last Node less than k.
+	// That Node's key is not less than k, so it is k unless k is less than it.
+	Node* current = nextAt(findPredecessor(k), 0);
+	if (current != nullptr && ! compare(k, current->key))
 	{
-		current = current->next;
+		return current;
 	}
+	return nullptr;
+}
 
-	// After finding correct position, check if the key is already in the linked list
-	if (current->next != nullptr && current->next->key == k)
+template<typename Key, typename Value, typename Compare, typename Allocator>
+typename SortedList<Key,Value,Compare,Allocator>::Node* SortedList<Key,Value,Compare,Allocator>::findRank(size_t rank) const noexcept
+{
+	// Start at the head on the highest level in use
+	Node* current = nullptr;
+	size_t currentRank = 0;
+	for (unsigned level = levels; level-- > 0;)
 	{
-		// Delete newNode and return false
-		delete newNode;
-		return false;
+		// Move forward on this level as long as that doesn't jump past the rank, then drop down a level
+		Node* next = nextAt(current, level);
+		while (next != nullptr && currentRank + (level == 0 ? 1 : spanAt(current, level)) <= rank)
+		{
+			currentRank += level == 0 ? 1 : spanAt(current, level);
+			current = next;
+			next = nextAt(current, level);
+		}
 	}
+	return currentRank == rank ? current : nullptr;
+}
 
-	// If not, set the newNode into the doubly linked list
-	newNode->next = current->next;
-	// If current->next is not the last node, make its previous newNode
-	if (current->next != nullptr)
+template<typename Key, typename Value, typename Compare, typename Allocator>
+void SortedList<Key,Value,Compare,Allocator>::predecessorsOf(Node* x, Path & path) const noexcept
+{
+	Node* current = x;
+	size_t rank = count;
+	for (unsigned level = 0; level < levels; level++)
 	{
-		current->next->prev = newNode;
+		// Walk back on the level below until reaching a Node that is also linked into this level
+		while (current != nullptr && current->height <= level)
+		{
+			current = prevAt(current, level - 1);
+			rank -= level == 1 ? 1 : spanAt(current, level - 1);
+		}
+		path.update[level] = current;
+		path.rank[level] = rank;
+	}
+	// The ranks were counted back from the tail's rank, which is only right if x is the tail.
+	// Otherwise, walk back to the head on the top level (which has only a few Nodes)
+	// to find out how far off they are, since the head's rank is 0.
+	if (x != tail)
+	{
+		unsigned top = levels - 1;
+		while (current != nullptr)
+		{
+			current = prevAt(current, top);
+			rank -= top == 0 ? 1 : spanAt(current, top);
+		}
+		for (unsigned level = 0; level < levels; level++)
+		{
+			path.rank[level] -= rank;
+		}
 	}
-	// Set current->next to newNode and the newNode prev to current and return true
-	current->next = newNode;
-	newNode->prev = current;
-	return true;
 }
 
-
-
-
-template<typename Key, typename Value>
-bool SortedList<Key,Value>::contains(const Key &k) const noexcept
+template<typename Key, typename Value, typename Compare, typename Allocator>
+void SortedList<Key,Value,Compare,Allocator>::linkNode(Node* n, Path & path) noexcept
 {
-	// Initialize a Node pointer
-	Node* current = head;
-	// Loop through all the nodes to see if doubly linked list contains that key
-	while (current != nullptr)
+	// If n is taller than every other Node, the new levels start at the head and jump to the end
+	while (levels < n->height)
+	{
+		path.update[levels] = nullptr;
+		path.rank[levels] = 0;
+		headLinks[levels - 1].span = count + 1;
+		levels++;
+	}
+	// n goes right after path.update[0]
+	size_t rank = path.rank[0] + 1;
+	// Splice n in between update[level] and its next Node on each of its levels
+	for (unsigned level = 0; level < n->height; level++)
 	{
-		// Check if the current Node's key is == k
-		if (current->key == k)
+		Node* before = path.update[level];
+		Node* next = nextAt(before, level);
+		setNext(n, level, next);
+		setPrev(n, level, before);
+		setPrev(next, level, n);
+		setNext(before, level, n);
+		// Split the old link's span between before -> n and n -> next
+		if (level > 0)
 		{
-			return true;
+			spanAt(n, level) = path.rank[level] + spanAt(before, level) + 1 - rank;
+			spanAt(before, level) = rank - path.rank[level];
 		}
-		// Increment Node
-		current = current->next;
 	}
-	// If not, return false
-	return false;
+	// The links that jump over n on the levels above it now jump one more Node
+	for (unsigned level = n->height; level < levels; level++)
+	{
+		spanAt(path.update[level], level)++;
+	}
+	count++;
 }
 
-template<typename Key, typename Value>
-void SortedList<Key,Value>::remove(const Key &k) 
+template<typename Key, typename Value, typename Compare, typename Allocator>
+void SortedList<Key,Value,Compare,Allocator>::unlinkNode(Node* n, const Path* path) noexcept
 {
-	// Initialize Node pointer
-	Node* current = head;
-	// Loop through the Nodes until one is found with that key
-	while (current != nullptr && current->key != k)
-	{
-		current = current->next;
-	}
-	// If there is a key, continue. If not, silently end.
-	if (current != nullptr)
+	// Connect n's neighbours to each other on each of its levels
+	for (unsigned level = 0; level < n->height; level++)
 	{
-		// Set the Nodes prev Node to its prev Node value
-		if (current->prev != nullptr)
+		Node* prev = prevAt(n, level);
+		Node* next = nextAt(n, level);
+		setNext(prev, level, next);
+		setPrev(next, level, prev);
+		// The merged link jumps over what both links did, except n itself
+		if (level > 0)
 		{
-			current->prev->next = current->next;
+			spanAt(prev, level) += spanAt(n, level) - 1;
 		}
-		// It's the first Node so make the second Node the first
-		else
+	}
+	// The links that jump over n on the levels above it now jump one less Node.
+	// Walk back on the level below until reaching a Node that is linked into each of those levels.
+	Node* current = n;
+	for (unsigned level = n->height; level < levels; level++)
+	{
+		if (path != nullptr)
 		{
-			head = current->next;
+			current = path->update[level];
 		}
-		// Set the Nodes next Node to its next Node value
-		if (current->next != nullptr)
+		while (current != nullptr && current->height <= level)
 		{
-			current->next->prev = current->prev;
+			current = prevAt(current, level - 1);
 		}
-		// Delete the Node after adjustments to next and prev
-		delete current;
+		spanAt(current, level)--;
 	}
+	dropEmptyLevels();
+	count--;
 }
 
-
-
-// If this key exists in the list, this function returns how many keys are in the list that are less than it.
-// If this key does not exist in the list, this throws a KeyNotFoundException.
-template<typename Key, typename Value>
-unsigned SortedList<Key,Value>::getIndex(const Key &k) const
+template<typename Key, typename Value, typename Compare, typename Allocator>
+void SortedList<Key,Value,Compare,Allocator>::dropEmptyLevels() noexcept
 {
-	// Set current Node to a Node pointer
-	Node* current = head;
-	// Loop through the nodes while current is not nullptr and the key is not found
-	while(current != nullptr && current->key != k)
+	while (levels > 1 && headLinks[levels - 2].next == nullptr)
 	{
-		current = current->next;
+		levels--;
 	}
-	// If current is not null, find the index
-	if (current != nullptr)
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+template<typename... Args>
+void SortedList<Key,Value,Compare,Allocator>::placeNode(Path & path, unsigned height, Args&&... args)
+{
+	Node* newNode = createNode(height, std::forward<Args>(args)...);
+	size_t rank = path.rank[0] + 1;
+	linkNode(newNode, path);
+	// The new Node is now the one to follow on each of its levels
+	for (unsigned level = 0; level < height; level++)
 	{
-		unsigned index = 0;
-		// Loop by counting down until null
-		while (current->prev != nullptr)
-		{
-			current = current->prev;
-			index ++;
-		}
-		return index;
+		path.update[level] = newNode;
+		path.rank[level] = rank;
 	}
-	// If the current is null, that means the key does not exist
-	throw KeyNotFoundException{"Key not found in list"};
-
 }
 
-template<typename Key, typename Value>
-Value & SortedList<Key,Value>::operator[] (const Key &k) 
+template<typename Key, typename Value, typename Compare, typename Allocator>
+void SortedList<Key,Value,Compare,Allocator>::copyNodes(const SortedList & st)
 {
-	// Initialize Node pointer
-	Node* current = head;
-	// Loop through all the Nodes until the key is found
-	while (current != nullptr && current->key !=k)
+	// The copies are appended in order, so the last Node on every level is where the next one goes
+	Path last = {};
+	// Loop through all the Nodes
+	for (Node* current = st.head; current != nullptr; current = current->next)
 	{
-		current = current->next;
+		// Give the copy the same height, so the index keeps the same shape
+		placeNode(last, current->height, current->key, current->value);
 	}
-	// If key is found, return its value
-	if (current != nullptr)
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+void SortedList<Key,Value,Compare,Allocator>::shareNodes(const SortedList & st) noexcept
+{
+	// Both lists look at the same Nodes, so the head's links and the counts are all it takes
+	head = st.head;
+	tail = st.tail;
+	count = st.count;
+	std::copy(std::begin(st.headLinks), std::end(st.headLinks), std::begin(headLinks));
+	levels = st.levels;
+	storage = st.storage;
+	if (storage != nullptr)
 	{
-		return current->value;
+		storage->owners.fetch_add(1, std::memory_order_relaxed);
 	}
-	// If it is not, throw exception
-	throw KeyNotFoundException{"Key not found in list"};
 }
 
-template<typename Key, typename Value>
-const Value & SortedList<Key,Value>::operator[] (const Key &k) const 
+template<typename Key, typename Value, typename Compare, typename Allocator>
+bool SortedList<Key,Value,Compare,Allocator>::unshare()
 {
-	// Initialize Node pointer
-	Node* current = head;
-	// Loop through all the Nodes until the key is found
-	while (current != nullptr && current->key !=k)
+	// Once every other list has let go, the Nodes are this list's to change.
+	// (Acquire, so their reads of the Nodes are done before this list's changes.)
+	if (storage == nullptr || storage->owners.load(std::memory_order_acquire) == 1)
 	{
-		current = current->next;
+		return false;
 	}
-	// If key is found, return its value
-	if (current != nullptr)
+	SortedList copy(compare, allocator);
+	copy.heightSeed = heightSeed;
+	copy.copyNodes(*this);
+	// The copy takes this list's share of the old Nodes with it when it goes
+	swap(copy);
+	return true;
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+bool SortedList<Key,Value,Compare,Allocator>::exposeNodes()
+{
+	bool copied = unshare();
+	exposed = true;
+	return copied;
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+void SortedList<Key,Value,Compare,Allocator>::releaseNodes() noexcept
+{
+	// The last list to let go of the Nodes deletes them, along with the Storage
+	if (storage != nullptr && storage->owners.fetch_sub(1, std::memory_order_acq_rel) == 1)
 	{
-		return current->value;
+		deleteNodes();
+		StorageAllocator storageAllocator(allocator);
+		std::destroy_at(storage);
+		StorageTraits::deallocate(storageAllocator, storage, 1);
 	}
-	// If it is not, throw exception
-	throw KeyNotFoundException{"Key not found in list"};
+	storage = nullptr;
+	resetNodes();
 }
 
-template<typename Key, typename Value>
-const Key & SortedList<Key,Value>::largestLessThan(const Key & k) const
+template<typename Key, typename Value, typename Compare, typename Allocator>
+void SortedList<Key,Value,Compare,Allocator>::deleteNodes() noexcept
 {
-	// Initialize Node pointer and Key pointer
-	Node* current = head;
-	Key* largestLessThan_key = nullptr;
-	// Loop through all the Nodes
-	while (current != nullptr)
+	// Loop through every Node and delete it
+	while (head != nullptr)
 	{
-		// Check if the current key is less than given key. If so, temporarily set it as the largestLessThan_key
-		if (current->key < k)
-		{
-			// Since the keys are in order, this will automatically pick the highest key
-			largestLessThan_key = &current->key;
-		}
-		// Increment Node
-		current = current->next;
+		Node* current = head;
+		head = head->next;
+		destroyNode(current);
 	}
-	// Check if a key was found
-	if (largestLessThan_key != nullptr)
+	resetNodes();
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+void SortedList<Key,Value,Compare,Allocator>::resetNodes() noexcept
+{
+	head = nullptr;
+	tail = nullptr;
+	count = 0;
+	// With no Nodes left, nothing handed out can change them
+	exposed = false;
+	// Reset the index to a single empty level
+	for (Link & link : headLinks)
 	{
-		return *largestLessThan_key;
+		link.prev = nullptr;
+		link.next = nullptr;
+		link.span = 1;
 	}
-	// If not, throw exception
-	throw KeyNotFoundException{"Key not found in list"};
+	levels = 1;
 }
 
-template<typename Key, typename Value>
-const Key & SortedList<Key,Value>::smallestGreaterThan(const Key & k) const
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+SortedList<Key,Value,Compare,Allocator>::SortedList()
+	: head(nullptr), tail(nullptr), count(0), headLinks{}, levels(1), heightSeed(0x9E3779B97F4A7C15ull), compare(),
+	  storage(nullptr), exposed(false), allocator()
+{}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+SortedList<Key,Value,Compare,Allocator>::SortedList(const Compare & comp, const Allocator & a)
+	: head(nullptr), tail(nullptr), count(0), headLinks{}, levels(1), heightSeed(0x9E3779B97F4A7C15ull), compare(comp),
+	  storage(nullptr), exposed(false), allocator(a)
+{}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+SortedList<Key,Value,Compare,Allocator>::SortedList(const Allocator & a)
+	: SortedList(Compare(), a)
+{}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+template<std::input_iterator InputIt>
+SortedList<Key,Value,Compare,Allocator>::SortedList(InputIt first, InputIt last, const Allocator & a)
+	: SortedList(first, last, Compare(), a)
+{}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+template<std::input_iterator InputIt>
+SortedList<Key,Value,Compare,Allocator>::SortedList(InputIt first, InputIt last, const Compare & comp, const Allocator & a)
+	: SortedList(comp, a)
 {
-	// Initialize Node pointer
-	Node* current = head;
-	// Loop through all the Nodes
-	while (current != nullptr)
+	// Where the next Node goes if it is larger than every key so far
+	Path end = {};
+	for (; first != last; ++first)
 	{
-		// Check if the key is greater than given key
-		if (current->key > k)
+		auto && [k, v] = *first;
+		if (tail == nullptr || compare(tail->key, k))
 		{
-			// Can simply return because the linked list is in ascending order
-			return current->key;
+			placeNode(end, randomHeight(), k, v);
+		}
+		else
+		{
+			// Out of order: insert it the usual way, after which the end of the list has to be found again
+			insert(k, v);
+			predecessorsOf(tail, end);
 		}
-		// Increment Node
-		current = current->next;
 	}
-	// If no Nodes are found, then return exception
-	throw KeyNotFoundException{"Key not found in list"};
 }
 
 
+template<typename Key, typename Value, typename Compare, typename Allocator>
+SortedList<Key,Value,Compare,Allocator>::SortedList(const SortedList & st)
+	: head(nullptr), tail(nullptr), count(0), headLinks{}, levels(1), heightSeed(st.heightSeed), compare(st.compare),
+	  storage(nullptr), exposed(false), allocator(std::allocator_traits<Allocator>::select_on_container_copy_construction(st.get_allocator()))
+{
+	// SortedList l1 = l2: share st's Nodes, unless they came from an allocator this list can't give them back to,
+	// or something handed out by st could still change them
+	if (allocator == st.allocator && ! st.exposed)
+	{
+		shareNodes(st);
+	}
+	else
+	{
+		copyNodes(st);
+	}
+}
+
 
-template <typename Key, typename Value>
-bool SortedList<Key,Value>::operator==(const SortedList & l) const noexcept
+template<typename Key, typename Value, typename Compare, typename Allocator>
+SortedList<Key,Value,Compare,Allocator> & SortedList<Key,Value,Compare,Allocator>::operator=(const SortedList & st)
 {
-	// Initialize Node pointers for SortedList and l
-	Node* current = head;
-	Node* currentl = l.head;
-	// Loop through all Nodes in both SortedLists
-	while (current != nullptr && currentl != nullptr)
+	// l1 = l2
+	if ( this != &st )
 	{
-		// Check if the keys and values are the same. If not, return false
-		if (current->key != currentl->key || current->value != currentl->value)
+		// Let go of all the Nodes in SortedList, then share (or copy) st's, along with the order they are in
+		releaseNodes();
+		compare = st.compare;
+		heightSeed = st.heightSeed;
+		if (allocator == st.allocator && ! st.exposed)
 		{
-			return false;
+			shareNodes(st);
+		}
+		else
+		{
+			copyNodes(st);
 		}
-		// Increment Nodes
-		current = current->next;
-		currentl = currentl->next;
 	}
-	// Ensures that both lists are the same length and have the same key/value pairs
-	return current == nullptr && currentl == nullptr;
+	return *this;
 }
 
-template <typename Key, typename Value>
-void SortedList<Key,Value>::operator++()
+template<typename Key, typename Value, typename Compare, typename Allocator>
+SortedList<Key,Value,Compare,Allocator>::~SortedList()
 {
-	// Initialize a Node pointer
-	Node* current = head;
-	// Loop through every Node
-	while (current != nullptr)
-	{
-		// Increment the value and go to next Node
-		current->value++;
-		current = current->next;
-	}
+	releaseNodes();
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+SortedList<Key,Value,Compare,Allocator>::SortedList(SortedList && st) noexcept
+	: head(st.head), tail(st.tail), count(st.count), levels(st.levels), heightSeed(st.heightSeed),
+	  compare(std::move(st.compare)), storage(st.storage), exposed(st.exposed), allocator(st.allocator)
+{
+	// The towers point at Nodes, never at the head's links, so those can simply be copied over
+	std::copy(std::begin(st.headLinks), std::end(st.headLinks), std::begin(headLinks));
+	st.storage = nullptr;
+	st.resetNodes();
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+SortedList<Key,Value,Compare,Allocator> & SortedList<Key,Value,Compare,Allocator>::operator=(SortedList && st) noexcept
+{
+	// Take st's Nodes, and let the temporary delete the ones this list had
+	SortedList moved(std::move(st));
+	swap(moved);
+	return *this;
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+void SortedList<Key,Value,Compare,Allocator>::swap(SortedList & other) noexcept
+{
+	using std::swap;
+	swap(head, other.head);
+	swap(tail, other.tail);
+	swap(count, other.count);
+	swap(headLinks, other.headLinks);
+	swap(levels, other.levels);
+	swap(heightSeed, other.heightSeed);
+	swap(compare, other.compare);
+	swap(storage, other.storage);
+	swap(exposed, other.exposed);
+	swap(allocator, other.allocator);
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+Allocator SortedList<Key,Value,Compare,Allocator>::get_allocator() const noexcept
+{
+	return allocator;
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+Compare SortedList<Key,Value,Compare,Allocator>::key_comp() const
+{
+	return compare;
+}
+
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+size_t SortedList<Key,Value,Compare,Allocator>::size() const noexcept
+{
+	// The counter is updated by every function that adds or removes Nodes
+	return count;
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+bool SortedList<Key,Value,Compare,Allocator>::isEmpty() const noexcept
+{
+	// If there is no Nodes, return true. Else return false.
+	if (head == nullptr)
+	{
+		return true;
+	}
+	return false;
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+const Key & SortedList<Key,Value,Compare,Allocator>::front() const
+{
+	// The smallest key is always at the head
+	if (head != nullptr)
+	{
+		return head->key;
+	}
+	throw KeyNotFoundException{"List is empty"};
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+const Key & SortedList<Key,Value,Compare,Allocator>::back() const
+{
+	// The largest key is always at the tail
+	if (tail != nullptr)
+	{
+		return tail->key;
+	}
+	throw KeyNotFoundException{"List is empty"};
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+void SortedList<Key,Value,Compare,Allocator>::popFront()
+{
+	unshare();
+	// If there is a head, unlink it and make the second Node the first
+	if (head != nullptr)
+	{
+		Node* current = head;
+		unlinkNode(current);
+		destroyNode(current);
+	}
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+void SortedList<Key,Value,Compare,Allocator>::popBack()
+{
+	unshare();
+	// If there is a tail, unlink it and make the second to last Node the last
+	if (tail != nullptr)
+	{
+		Node* current = tail;
+		unlinkNode(current);
+		destroyNode(current);
+	}
+}
+
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+typename SortedList<Key,Value,Compare,Allocator>::Node* SortedList<Key,Value,Compare,Allocator>::findLowerBound(const Key & k) const
+{
+	// The Node after the last one less than k
+	return nextAt(findPredecessor(k), 0);
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+typename SortedList<Key,Value,Compare,Allocator>::Node* SortedList<Key,Value,Compare,Allocator>::findUpperBound(const Key & k) const
+{
+	// The first Node that is not less than k is either k itself or the answer
+	Node* current = findLowerBound(k);
+	if (current != nullptr && ! compare(k, current->key))
+	{
+		current = current->next;
+	}
+	return current;
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+typename SortedList<Key,Value,Compare,Allocator>::Node* SortedList<Key,Value,Compare,Allocator>::findFloor(const Key & k) const
+{
+	// The last Node less than k is the answer, unless the Node after it is k itself
+	Node* current = findPredecessor(k);
+	Node* next = nextAt(current, 0);
+	if (next != nullptr && ! compare(k, next->key))
+	{
+		return next;
+	}
+	return current;
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+bool SortedList<Key,Value,Compare,Allocator>::findRangePaths(const Key & lo, const Key & hi, Path & from, Path & to) const
+{
+	if (! compare(lo, hi))
+	{
+		return false;
+	}
+	// Find the last Node before lo on every level, and from there the last Node before hi
+	findPredecessor(lo, &from);
+	to = from;
+	advanceInsertPath(hi, to);
+	return true;
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+bool SortedList<Key,Value,Compare,Allocator>::findInsertPath(const Key & k, Path & path) const
+{
+	// If the key is larger than the current largest key, it goes right after the tail.
+	// This is the common case for keys that arrive in increasing order, so it skips the search.
+	if (tail != nullptr && compare(tail->key, k))
+	{
+		predecessorsOf(tail, path);
+		return true;
+	}
+	// Search the index for the last Node on every level whose key is less than k
+	Node* current = findPredecessor(k, &path);
+	// After finding correct position, check if the key is already in the linked list
+	Node* next = nextAt(current, 0);
+	return next == nullptr || compare(k, next->key);
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+bool SortedList<Key,Value,Compare,Allocator>::advanceInsertPath(const Key & k, Path & path) const
+{
+	// Find how many of the levels have a link out of path that lands on a key less than k.
+	// If a level's link doesn't, the links above it don't either, so those levels are already right.
+	unsigned stale = 0;
+	while (stale < levels)
+	{
+		Node* next = nextAt(path.update[stale], stale);
+		if (next == nullptr || ! compare(next->key, k))
+		{
+			break;
+		}
+		stale++;
+	}
+	// Search down through those levels as findPredecessor does, starting from where path was
+	if (stale > 0)
+	{
+		Node* current = path.update[stale - 1];
+		size_t rank = path.rank[stale - 1];
+		for (unsigned level = stale; level-- > 0;)
+		{
+			Node* next = nextAt(current, level);
+			while (next != nullptr && compare(next->key, k))
+			{
+				rank += level == 0 ? 1 : spanAt(current, level);
+				current = next;
+				next = nextAt(current, level);
+			}
+			path.update[level] = current;
+			path.rank[level] = rank;
+		}
+	}
+	// Check if the key is already in the list
+	Node* next = nextAt(path.update[0], 0);
+	return next == nullptr || compare(k, next->key);
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+bool SortedList<Key,Value,Compare,Allocator>::findInsertPathNear(Node* hint, const Key & k, Path & path) const
+{
+	// k belongs right before the hint if it falls between the hint and the Node before it
+	Node* before = hint != nullptr ? hint->prev : tail;
+	Node* after = hint;
+	for (unsigned steps = 0; steps <= MaxHintSteps; steps++)
+	{
+		// If it doesn't, move the gap one Node towards k
+		if (before != nullptr && compare(k, before->key))
+		{
+			after = before;
+			before = before->prev;
+		}
+		else if (after != nullptr && compare(after->key, k))
+		{
+			before = after;
+			after = after->next;
+		}
+		// Now k is not less than before and after is not less than k
+		else if (before != nullptr && ! compare(before->key, k))
+		{
+			path.update[0] = before->prev;
+			return false;
+		}
+		else if (after != nullptr && ! compare(k, after->key))
+		{
+			path.update[0] = before;
+			return false;
+		}
+		else
+		{
+			// k goes between before and after, so only the index above before has to be found
+			predecessorsOf(before, path);
+			return true;
+		}
+	}
+	// The hint was too far from k to be of use
+	return findInsertPath(k, path);
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+template<typename K, typename... Args>
+bool SortedList<Key,Value,Compare,Allocator>::insertIfAbsent(K&& k, Args&&... args)
+{
+	unshare();
+	// Nothing is made until the search has shown the key is new, so a duplicate costs only the search
+	Path path;
+	if (! findInsertPath(k, path))
+	{
+		return false;
+	}
+	// If not, make a new Node and set it into the list right after those Nodes
+	Node* newNode = createNode(randomHeight(), std::forward<K>(k), std::forward<Args>(args)...);
+	linkNode(newNode, path);
+	return true;
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+template<typename K, typename... Args>
+typename SortedList<Key,Value,Compare,Allocator>::Node* SortedList<Key,Value,Compare,Allocator>::insertNear(Node* hint, K&& k, Args&&... args)
+{
+	// A hint into the Nodes this list shared is no use once it has its own
+	if (exposeNodes())
+	{
+		hint = nullptr;
+	}
+	Path path;
+	if (! findInsertPathNear(hint, k, path))
+	{
+		return nextAt(path.update[0], 0);
+	}
+	Node* newNode = createNode(randomHeight(), std::forward<K>(k), std::forward<Args>(args)...);
+	linkNode(newNode, path);
+	return newNode;
+}
+
+
+// If this key is already present, return false.
+// otherwise, return true after inserting this key/value pair/.
+template<typename Key, typename Value, typename Compare, typename Allocator>
+bool SortedList<Key,Value,Compare,Allocator>::insert(const Key &k, const Value &v)
+{
+	return insertIfAbsent(k, v);
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+bool SortedList<Key,Value,Compare,Allocator>::insert(Key &&k, Value &&v)
+{
+	return insertIfAbsent(std::move(k), std::move(v));
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+template<typename... Args>
+bool SortedList<Key,Value,Compare,Allocator>::emplace(Args&&... args)
+{
+	unshare();
+	// The key only exists once the Node is made, so make it first
+	Node* newNode = createNode(randomHeight(), std::forward<Args>(args)...);
+	Path path;
+	if (! findInsertPath(newNode->key, path))
+	{
+		// The key is already present, so throw the new Node away
+		destroyNode(newNode);
+		return false;
+	}
+	linkNode(newNode, path);
+	return true;
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+typename SortedList<Key,Value,Compare,Allocator>::iterator SortedList<Key,Value,Compare,Allocator>::insert(const_iterator hint, const Key &k, const Value &v)
+{
+	return iterator(this, insertNear(hint.node, k, v));
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+typename SortedList<Key,Value,Compare,Allocator>::iterator SortedList<Key,Value,Compare,Allocator>::insert(const_iterator hint, Key &&k, Value &&v)
+{
+	return iterator(this, insertNear(hint.node, std::move(k), std::move(v)));
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+template<typename... Args>
+typename SortedList<Key,Value,Compare,Allocator>::iterator SortedList<Key,Value,Compare,Allocator>::emplace_hint(const_iterator hint, Args&&... args)
+{
+	Node* near = exposeNodes() ? nullptr : hint.node;
+	// As in emplace, the key only exists once the Node is made
+	Node* newNode = createNode(randomHeight(), std::forward<Args>(args)...);
+	Path path;
+	if (! findInsertPathNear(near, newNode->key, path))
+	{
+		destroyNode(newNode);
+		return iterator(this, nextAt(path.update[0], 0));
+	}
+	linkNode(newNode, path);
+	return iterator(this, newNode);
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+template<std::input_iterator InputIt>
+void SortedList<Key,Value,Compare,Allocator>::assignSorted(InputIt first, InputIt last)
+{
+	// Build the new contents on the side, so nothing changes if the keys turn out not to be sorted
+	SortedList sorted(compare, get_allocator());
+	Path end = {};
+	for (; first != last; ++first)
+	{
+		auto && [k, v] = *first;
+		if (sorted.tail != nullptr && ! compare(sorted.tail->key, k))
+		{
+			throw std::invalid_argument{"Keys are not sorted and unique"};
+		}
+		sorted.placeNode(end, sorted.randomHeight(), k, v);
+	}
+	swap(sorted);
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+template<std::ranges::forward_range Batch>
+std::vector<bool> SortedList<Key,Value,Compare,Allocator>::insertBatch(Batch && batch)
+{
+	unshare();
+	// Note where every pair is, and sort them by key. The sort is stable, so the first of any repeated keys comes first.
+	std::vector<std::ranges::iterator_t<Batch>> pairs;
+	for (auto it = std::ranges::begin(batch); it != std::ranges::end(batch); ++it)
+	{
+		pairs.push_back(it);
+	}
+	std::vector<size_t> order(pairs.size());
+	for (size_t i = 0; i < order.size(); i++)
+	{
+		order[i] = i;
+	}
+	std::stable_sort(order.begin(), order.end(), [this, &pairs](size_t a, size_t b)
+	{
+		auto && [ka, va] = *pairs[a];
+		auto && [kb, vb] = *pairs[b];
+		return compare(ka, kb);
+	});
+	// Merge them into the list in order: each key goes somewhere after the one before it,
+	// so its place is found by moving on from there
+	std::vector<bool> inserted(pairs.size());
+	Path path = {};
+	for (size_t j = 0; j < order.size(); j++)
+	{
+		auto && [k, v] = *pairs[order[j]];
+		// A key repeated in the batch was dealt with the first time it came up
+		if (j > 0)
+		{
+			auto && [previous, pv] = *pairs[order[j - 1]];
+			if (! compare(previous, k))
+			{
+				continue;
+			}
+		}
+		if (advanceInsertPath(k, path))
+		{
+			placeNode(path, randomHeight(), k, v);
+			inserted[order[j]] = true;
+		}
+	}
+	return inserted;
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+template<typename... Args>
+bool SortedList<Key,Value,Compare,Allocator>::try_emplace(const Key &k, Args&&... args)
+{
+	return insertIfAbsent(k, std::forward<Args>(args)...);
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+template<typename... Args>
+bool SortedList<Key,Value,Compare,Allocator>::try_emplace(Key &&k, Args&&... args)
+{
+	return insertIfAbsent(std::move(k), std::forward<Args>(args)...);
+}
+
+
+
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+bool SortedList<Key,Value,Compare,Allocator>::contains(const Key &k) const noexcept
+{
+	// Search the index for a Node with that key
+	return findNode(k) != nullptr;
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+typename SortedList<Key,Value,Compare,Allocator>::iterator SortedList<Key,Value,Compare,Allocator>::find(const Key &k)
+{
+	exposeNodes();
+	return iterator(this, findNode(k));
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+typename SortedList<Key,Value,Compare,Allocator>::const_iterator SortedList<Key,Value,Compare,Allocator>::find(const Key &k) const
+{
+	return const_iterator(this, findNode(k));
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+Value* SortedList<Key,Value,Compare,Allocator>::tryGet(const Key &k)
+{
+	exposeNodes();
+	Node* current = findNode(k);
+	return current != nullptr ? &current->value : nullptr;
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+const Value* SortedList<Key,Value,Compare,Allocator>::tryGet(const Key &k) const
+{
+	Node* current = findNode(k);
+	return current != nullptr ? &current->value : nullptr;
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+template<typename K> requires TransparentCompare<Compare>
+bool SortedList<Key,Value,Compare,Allocator>::contains(const K &k) const noexcept
+{
+	return findNode(k) != nullptr;
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+template<typename K> requires TransparentCompare<Compare>
+typename SortedList<Key,Value,Compare,Allocator>::iterator SortedList<Key,Value,Compare,Allocator>::find(const K &k)
+{
+	exposeNodes();
+	return iterator(this, findNode(k));
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+template<typename K> requires TransparentCompare<Compare>
+typename SortedList<Key,Value,Compare,Allocator>::const_iterator SortedList<Key,Value,Compare,Allocator>::find(const K &k) const
+{
+	return const_iterator(this, findNode(k));
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+template<typename K> requires TransparentCompare<Compare>
+Value* SortedList<Key,Value,Compare,Allocator>::tryGet(const K &k)
+{
+	exposeNodes();
+	Node* current = findNode(k);
+	return current != nullptr ? &current->value : nullptr;
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+template<typename K> requires TransparentCompare<Compare>
+const Value* SortedList<Key,Value,Compare,Allocator>::tryGet(const K &k) const
+{
+	Node* current = findNode(k);
+	return current != nullptr ? &current->value : nullptr;
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+void SortedList<Key,Value,Compare,Allocator>::remove(const Key &k) 
+{
+	unshare();
+	// Search the index for a Node with that key
+	Node* current = findNode(k);
+	// If there is a key, continue. If not, silently end.
+	if (current != nullptr)
+	{
+		// Unlink the Node from every level, then delete it
+		unlinkNode(current);
+		destroyNode(current);
+	}
+}
+
+
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+size_t SortedList<Key,Value,Compare,Allocator>::removeRange(const Key &lo, const Key &hi)
+{
+	unshare();
+	Path from;
+	Path to;
+	if (! findRangePaths(lo, hi, from, to))
+	{
+		return 0;
+	}
+	size_t removed = to.rank[0] - from.rank[0];
+	if (removed == 0)
+	{
+		return 0;
+	}
+	Node* first = nextAt(from.update[0], 0);
+	for (unsigned level = 0; level < levels; level++)
+	{
+		Node* before = from.update[level];
+		// If some of the Nodes being removed are on this level, join the Node before them to the Node after them
+		if (to.update[level] != before)
+		{
+			Node* after = nextAt(to.update[level], level);
+			if (level > 0)
+			{
+				spanAt(before, level) = to.rank[level] + spanAt(to.update[level], level) - from.rank[level];
+			}
+			setNext(before, level, after);
+			setPrev(after, level, before);
+		}
+		// Either way, the link now jumps over that many fewer Nodes
+		if (level > 0)
+		{
+			spanAt(before, level) -= removed;
+		}
+	}
+	dropEmptyLevels();
+	count -= removed;
+	// The removed Nodes are still linked to each other on level 0, so delete them in order
+	for (size_t i = 0; i < removed; i++)
+	{
+		Node* next = first->next;
+		destroyNode(first);
+		first = next;
+	}
+	return removed;
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+template<typename Pred>
+size_t SortedList<Key,Value,Compare,Allocator>::removeIf(Pred pred)
+{
+	unshare();
+	// Rather than unlink Nodes one at a time, link every Node that stays after the last one that
+	// stayed on each of its levels, so the whole index is rebuilt in the one walk
+	Path last = {};
+	size_t kept = 0;
+	auto keep = [this, &last, &kept](Node* n)
+	{
+		kept++;
+		for (unsigned level = 0; level < n->height; level++)
+		{
+			setNext(last.update[level], level, n);
+			setPrev(n, level, last.update[level]);
+			if (level > 0)
+			{
+				spanAt(last.update[level], level) = kept - last.rank[level];
+			}
+			last.update[level] = n;
+			last.rank[level] = kept;
+		}
+	};
+	// After the walk, end every level after the last Node that stayed on it
+	auto finish = [this, &last, &kept]()
+	{
+		for (unsigned level = 0; level < levels; level++)
+		{
+			setNext(last.update[level], level, nullptr);
+			setPrev(nullptr, level, last.update[level]);
+			if (level > 0)
+			{
+				spanAt(last.update[level], level) = kept + 1 - last.rank[level];
+			}
+		}
+		count = kept;
+		dropEmptyLevels();
+	};
+	size_t removed = 0;
+	Node* current = head;
+	try
+	{
+		while (current != nullptr)
+		{
+			Node* next = current->next;
+			if (pred(static_cast<const Entry &>(*current)))
+			{
+				destroyNode(current);
+				removed++;
+			}
+			else
+			{
+				keep(current);
+			}
+			current = next;
+		}
+	}
+	catch (...)
+	{
+		// If pred throws, keep the rest of the Nodes so the list is left whole
+		for (; current != nullptr; current = current->next)
+		{
+			keep(current);
+		}
+		finish();
+		throw;
+	}
+	finish();
+	return removed;
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+template<std::ranges::input_range Keys>
+size_t SortedList<Key,Value,Compare,Allocator>::removeBatch(const Keys & keys)
+{
+	unshare();
+	size_t removed = 0;
+	// path follows the keys through the list, starting from the head
+	Path path = {};
+	for (const Key & k : keys)
+	{
+		// A key that isn't past where path is (because it is smaller than the one before it)
+		// has to be looked for from the head again
+		if (path.update[0] != nullptr && ! compare(path.update[0]->key, k))
+		{
+			path = {};
+		}
+		if (! advanceInsertPath(k, path))
+		{
+			Node* current = nextAt(path.update[0], 0);
+			unlinkNode(current, &path);
+			destroyNode(current);
+			removed++;
+		}
+	}
+	return removed;
+}
+
+
+// If this key exists in the list, this function returns how many keys are in the list that are less than it.
+// If this key does not exist in the list, this throws a KeyNotFoundException.
+template<typename Key, typename Value, typename Compare, typename Allocator>
+unsigned SortedList<Key,Value,Compare,Allocator>::getIndex(const Key &k) const
+{
+	std::optional<unsigned> index = tryGetIndex(k);
+	if (index)
+	{
+		return *index;
+	}
+	// If there is no index, that means the key does not exist
+	throw KeyNotFoundException{"Key not found in list"};
+
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+std::optional<unsigned> SortedList<Key,Value,Compare,Allocator>::tryGetIndex(const Key &k) const
+{
+	// Search the index for the last Node less than k, adding up the spans on the way.
+	// Its rank is how many keys are less than k.
+	Path path;
+	Node* current = nextAt(findPredecessor(k, &path), 0);
+	// If current has the key, that rank is the index
+	if (current != nullptr && ! compare(k, current->key))
+	{
+		return path.rank[0];
+	}
+	return std::nullopt;
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+const Key & SortedList<Key,Value,Compare,Allocator>::keyAt(unsigned i) const
+{
+	// The Node with index i has rank i + 1
+	Node* current = findRank(size_t(i) + 1);
+	if (current != nullptr)
+	{
+		return current->key;
+	}
+	throw std::out_of_range{"Index out of range"};
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+Value & SortedList<Key,Value,Compare,Allocator>::atIndex(unsigned i)
+{
+	exposeNodes();
+	// The Node with index i has rank i + 1
+	Node* current = findRank(size_t(i) + 1);
+	if (current != nullptr)
+	{
+		return current->value;
+	}
+	throw std::out_of_range{"Index out of range"};
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+const Value & SortedList<Key,Value,Compare,Allocator>::atIndex(unsigned i) const
+{
+	// The Node with index i has rank i + 1
+	Node* current = findRank(size_t(i) + 1);
+	if (current != nullptr)
+	{
+		return current->value;
+	}
+	throw std::out_of_range{"Index out of range"};
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+Value & SortedList<Key,Value,Compare,Allocator>::operator[] (const Key &k) 
+{
+	exposeNodes();
+	// Search the index for a Node with that key
+	Node* current = findNode(k);
+	// If key is found, return its value
+	if (current != nullptr)
+	{
+		return current->value;
+	}
+	// If it is not, throw exception
+	throw KeyNotFoundException{"Key not found in list"};
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+const Value & SortedList<Key,Value,Compare,Allocator>::operator[] (const Key &k) const 
+{
+	// Search the index for a Node with that key
+	Node* current = findNode(k);
+	// If key is found, return its value
+	if (current != nullptr)
+	{
+		return current->value;
+	}
+	// If it is not, throw exception
+	throw KeyNotFoundException{"Key not found in list"};
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+template<typename K> requires TransparentCompare<Compare>
+Value & SortedList<Key,Value,Compare,Allocator>::operator[] (const K &k)
+{
+	exposeNodes();
+	Node* current = findNode(k);
+	if (current != nullptr)
+	{
+		return current->value;
+	}
+	throw KeyNotFoundException{"Key not found in list"};
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+template<typename K> requires TransparentCompare<Compare>
+const Value & SortedList<Key,Value,Compare,Allocator>::operator[] (const K &k) const
+{
+	Node* current = findNode(k);
+	if (current != nullptr)
+	{
+		return current->value;
+	}
+	throw KeyNotFoundException{"Key not found in list"};
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+const Key & SortedList<Key,Value,Compare,Allocator>::largestLessThan(const Key & k) const
+{
+	// The search already stops at the last Node whose key is less than k
+	Node* current = findPredecessor(k);
+	// Check if a key was found
+	if (current != nullptr)
+	{
+		return current->key;
+	}
+	// If not, throw exception
+	throw KeyNotFoundException{"Key not found in list"};
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+const Key & SortedList<Key,Value,Compare,Allocator>::smallestGreaterThan(const Key & k) const
+{
+	Node* current = findUpperBound(k);
+	// Can simply return because the linked list is in ascending order
+	if (current != nullptr)
+	{
+		return current->key;
+	}
+	// If no Nodes are found, then return exception
+	throw KeyNotFoundException{"Key not found in list"};
+}
+
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+typename SortedList<Key,Value,Compare,Allocator>::iterator SortedList<Key,Value,Compare,Allocator>::lowerBound(const Key & k)
+{
+	exposeNodes();
+	return iterator(this, findLowerBound(k));
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+typename SortedList<Key,Value,Compare,Allocator>::const_iterator SortedList<Key,Value,Compare,Allocator>::lowerBound(const Key & k) const
+{
+	return const_iterator(this, findLowerBound(k));
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+typename SortedList<Key,Value,Compare,Allocator>::iterator SortedList<Key,Value,Compare,Allocator>::upperBound(const Key & k)
+{
+	exposeNodes();
+	return iterator(this, findUpperBound(k));
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+typename SortedList<Key,Value,Compare,Allocator>::const_iterator SortedList<Key,Value,Compare,Allocator>::upperBound(const Key & k) const
+{
+	return const_iterator(this, findUpperBound(k));
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+typename SortedList<Key,Value,Compare,Allocator>::iterator SortedList<Key,Value,Compare,Allocator>::floor(const Key & k)
+{
+	exposeNodes();
+	return iterator(this, findFloor(k));
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+typename SortedList<Key,Value,Compare,Allocator>::const_iterator SortedList<Key,Value,Compare,Allocator>::floor(const Key & k) const
+{
+	return const_iterator(this, findFloor(k));
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+typename SortedList<Key,Value,Compare,Allocator>::iterator SortedList<Key,Value,Compare,Allocator>::ceiling(const Key & k)
+{
+	exposeNodes();
+	return iterator(this, findLowerBound(k));
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+typename SortedList<Key,Value,Compare,Allocator>::const_iterator SortedList<Key,Value,Compare,Allocator>::ceiling(const Key & k) const
+{
+	return const_iterator(this, findLowerBound(k));
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+std::pair<typename SortedList<Key,Value,Compare,Allocator>::iterator, typename SortedList<Key,Value,Compare,Allocator>::iterator>
+	SortedList<Key,Value,Compare,Allocator>::equalRange(const Key & k)
+{
+	exposeNodes();
+	// The upper bound is the lower bound, or the Node after it if that is k
+	Node* lower = findLowerBound(k);
+	Node* upper = lower != nullptr && ! compare(k, lower->key) ? lower->next : lower;
+	return {iterator(this, lower), iterator(this, upper)};
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+std::pair<typename SortedList<Key,Value,Compare,Allocator>::const_iterator, typename SortedList<Key,Value,Compare,Allocator>::const_iterator>
+	SortedList<Key,Value,Compare,Allocator>::equalRange(const Key & k) const
+{
+	Node* lower = findLowerBound(k);
+	Node* upper = lower != nullptr && ! compare(k, lower->key) ? lower->next : lower;
+	return {const_iterator(this, lower), const_iterator(this, upper)};
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+std::ranges::subrange<typename SortedList<Key,Value,Compare,Allocator>::iterator> SortedList<Key,Value,Compare,Allocator>::range(const Key & lo, const Key & hi)
+{
+	exposeNodes();
+	Path from;
+	Path to;
+	if (! findRangePaths(lo, hi, from, to))
+	{
+		return {end(), end()};
+	}
+	return {iterator(this, nextAt(from.update[0], 0)), iterator(this, nextAt(to.update[0], 0))};
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+std::ranges::subrange<typename SortedList<Key,Value,Compare,Allocator>::const_iterator> SortedList<Key,Value,Compare,Allocator>::range(const Key & lo, const Key & hi) const
+{
+	Path from;
+	Path to;
+	if (! findRangePaths(lo, hi, from, to))
+	{
+		return {end(), end()};
+	}
+	return {const_iterator(this, nextAt(from.update[0], 0)), const_iterator(this, nextAt(to.update[0], 0))};
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+size_t SortedList<Key,Value,Compare,Allocator>::countRange(const Key & lo, const Key & hi) const
+{
+	// The ranks of the Nodes before each end differ by how many Nodes are in between
+	Path from;
+	Path to;
+	if (! findRangePaths(lo, hi, from, to))
+	{
+		return 0;
+	}
+	return to.rank[0] - from.rank[0];
+}
+
+
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+bool SortedList<Key,Value,Compare,Allocator>::operator==(const SortedList & l) const noexcept
+{
+	// Lists that share their Nodes (a copy that neither side has changed) are equal without a look at them
+	if (head == l.head && count == l.count)
+	{
+		return true;
+	}
+	// Initialize Node pointers for SortedList and l
+	Node* current = head;
+	Node* currentl = l.head;
+	// Loop through all Nodes in both SortedLists
+	while (current != nullptr && currentl != nullptr)
+	{
+		// Check if the keys and values are the same. If not, return false
+		if (current->key != currentl->key || current->value != currentl->value)
+		{
+			return false;
+		}
+		// Increment Nodes
+		current = current->next;
+		currentl = currentl->next;
+	}
+	// Ensures that both lists are the same length and have the same key/value pairs
+	return current == nullptr && currentl == nullptr;
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+void SortedList<Key,Value,Compare,Allocator>::operator++()
+{
+	unshare();
+	// Initialize a Node pointer
+	Node* current = head;
+	// Loop through every Node
+	while (current != nullptr)
+	{
+		// Increment the value and go to next Node
+		current->value++;
+		current = current->next;
+	}
+}
+
+
+
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+typename SortedList<Key,Value,Compare,Allocator>::iterator SortedList<Key,Value,Compare,Allocator>::begin()
+{
+	exposeNodes();
+	return iterator(this, head);
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+typename SortedList<Key,Value,Compare,Allocator>::iterator SortedList<Key,Value,Compare,Allocator>::end()
+{
+	// Moving back from the end reaches the tail, so this can change the Nodes too
+	exposeNodes();
+	return iterator(this, nullptr);
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+typename SortedList<Key,Value,Compare,Allocator>::const_iterator SortedList<Key,Value,Compare,Allocator>::begin() const noexcept
+{
+	return const_iterator(this, head);
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+typename SortedList<Key,Value,Compare,Allocator>::const_iterator SortedList<Key,Value,Compare,Allocator>::end() const noexcept
+{
+	return const_iterator(this, nullptr);
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+typename SortedList<Key,Value,Compare,Allocator>::const_iterator SortedList<Key,Value,Compare,Allocator>::cbegin() const noexcept
+{
+	return begin();
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+typename SortedList<Key,Value,Compare,Allocator>::const_iterator SortedList<Key,Value,Compare,Allocator>::cend() const noexcept
+{
+	return end();
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+typename SortedList<Key,Value,Compare,Allocator>::reverse_iterator SortedList<Key,Value,Compare,Allocator>::rbegin()
+{
+	return reverse_iterator(end());
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+typename SortedList<Key,Value,Compare,Allocator>::reverse_iterator SortedList<Key,Value,Compare,Allocator>::rend()
+{
+	return reverse_iterator(begin());
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+typename SortedList<Key,Value,Compare,Allocator>::const_reverse_iterator SortedList<Key,Value,Compare,Allocator>::rbegin() const noexcept
+{
+	return const_reverse_iterator(end());
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+typename SortedList<Key,Value,Compare,Allocator>::const_reverse_iterator SortedList<Key,Value,Compare,Allocator>::rend() const noexcept
+{
+	return const_reverse_iterator(begin());
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+typename SortedList<Key,Value,Compare,Allocator>::const_reverse_iterator SortedList<Key,Value,Compare,Allocator>::crbegin() const noexcept
+{
+	return rbegin();
+}
+
+template<typename Key, typename Value, typename Compare, typename Allocator>
+typename SortedList<Key,Value,Compare,Allocator>::const_reverse_iterator SortedList<Key,Value,Compare,Allocator>::crend() const noexcept
+{
+	return rend();
 }
 
 
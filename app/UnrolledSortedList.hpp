@@ -0,0 +1,999 @@
+#ifndef __UNROLLED_SORTED_LIST_HPP
+#define __UNROLLED_SORTED_LIST_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "NodePool.hpp"
+#include "SortedList.hpp"
+
+// A sorted list stored as an unrolled linked list. It has only SortedList's basic operations (insert, contains,
+// remove, getIndex, operator[], largestLessThan, smallestGreaterThan, front, back, ==, ++ and iteration), none of
+// the newer ones such as popFront, emplace, keyAt, find, lowerBound or the range operations.
+// Each Block holds up to BlockSize keys and values in contiguous, sorted arrays.
+// A full Block is split in half when something is inserted into it, and a Block that falls
+// below a quarter full is merged into a neighbour that has room for it.
+//
+// Searching, iterating and comparing mostly scan through arrays, so they take one cache miss
+// per Block instead of one per key. A search binary searches a directory of the Blocks
+// (by their last key), then the keys of one Block.
+// The price is that inserting and removing move up to BlockSize keys and values around,
+// and that keys and values don't stay at the same address.
+//
+// The directory is a plain vector of Block pointers, so each split or merge also shifts every pointer after
+// the Block in it: O(n / BlockSize) per split or merge, as one memmove. That is cheap next to the search up to
+// about a million keys, but beyond that it grows to dominate inserts and removes in the middle of the list.
+// For lists much larger than that, use SortedList, whose inserts and removes stay O(log n).
+// Keys are kept in the order given by Compare, as in SortedList.
+template<typename Key, typename Value, size_t BlockSize = 32, typename Compare = std::less<Key>, typename Allocator = std::allocator<std::pair<const Key, Value>>>
+class UnrolledSortedList
+{
+	static_assert(BlockSize >= 4, "a Block must be able to hold at least 4 keys");
+
+private:
+	// Fewer keys than this in a Block makes it try to merge with a neighbour
+	static constexpr size_t MinBlockSize = BlockSize / 4;
+	// Shifting keys and values along inside a Block can't fail halfway if moving them can't throw.
+	// Otherwise (as long as they can be copied) inserting into the middle of a Block copies it instead.
+	static constexpr bool ShiftsInPlace =
+		(std::is_nothrow_move_constructible_v<Key> && std::is_nothrow_move_assignable_v<Key> &&
+		 std::is_nothrow_move_constructible_v<Value> && std::is_nothrow_move_assignable_v<Value>) ||
+		! (std::is_copy_constructible_v<Key> && std::is_copy_constructible_v<Value>);
+
+	// a piece of the list. Only the first size keys and values exist.
+	struct Block
+	{
+		Block* prev;
+		Block* next;
+		size_t size;
+		alignas(Key) unsigned char keyStorage[sizeof(Key) * BlockSize];
+		alignas(Value) unsigned char valueStorage[sizeof(Value) * BlockSize];
+
+		Block() : prev(nullptr), next(nullptr), size(0) {}
+
+		Key* keys() noexcept { return std::launder(reinterpret_cast<Key*>(keyStorage)); }
+		const Key* keys() const noexcept { return std::launder(reinterpret_cast<const Key*>(keyStorage)); }
+		Value* values() noexcept { return std::launder(reinterpret_cast<Value*>(valueStorage)); }
+		const Value* values() const noexcept { return std::launder(reinterpret_cast<const Value*>(valueStorage)); }
+		const Key & lastKey() const noexcept { return keys()[size - 1]; }
+	};
+
+	Block* head;
+	Block* tail;
+	// number of keys in the list (not Blocks)
+	size_t count;
+	NodePool<Block, Allocator> blockPool;
+	// every Block, in order (inserting or erasing one shifts the ones after it, see above)
+	using Directory = std::vector<Block*, typename std::allocator_traits<Allocator>::template rebind_alloc<Block*>>;
+	Directory directory;
+	// the order of the keys
+	[[no_unique_address]] Compare compare;
+
+
+	// makes an empty Block and links it in right after b (or at the head if b is nullptr)
+	Block* createBlockAfter(Block* b);
+	// unlinks an empty Block and gives its memory back (the caller takes it out of the directory)
+	void destroyBlock(Block* b) noexcept;
+	// takes an empty Block out of the directory and destroys it
+	void discardBlock(Block* b) noexcept;
+	// puts copy, a Block not yet in the list, in b's place, and destroys b with its keys and values
+	void replaceBlock(Block* b, Block* copy) noexcept;
+	// returns where b, which must not be empty, is in the directory
+	typename Directory::iterator positionOf(const Block* b) noexcept;
+
+	// returns the first Block whose last key is >= k, or nullptr if every key is < k
+	Block* findBlock(const Key & k) const noexcept;
+	// returns the first Block whose last key is > k, or nullptr if every key is <= k
+	Block* findBlockAfter(const Key & k) const noexcept;
+	// returns the position in b of the first key that is >= k
+	size_t lowerBound(const Block* b, const Key & k) const noexcept;
+	// true if the key at position i of b (which must exist, and not be < k) is k
+	bool isKeyAt(const Block* b, size_t i, const Key & k) const noexcept;
+
+	// constructs at out copies of the n elements of from, with one made from x put in at position i.
+	// If one throws, the ones already made are destroyed again.
+	template<typename T, typename X>
+	static void copyAround(T* out, const T* from, size_t n, size_t i, X&& x);
+	// moves [first, last) into the empty memory at out, or copies it if a move could throw (so nothing
+	// has been lost if it does). If one throws, the ones already made are destroyed again.
+	template<typename T>
+	static void relocate(T* first, T* last, T* out);
+
+	// inserts a key and value at position i of b, which must not be full.
+	// If that throws, b is left as it was (but, if a move can throw, b may have been replaced by a copy).
+	template<typename K, typename V>
+	void insertAt(Block* b, size_t i, K&& k, V&& v);
+	// inserts k and v if k isn't in the list yet, and returns whether it did
+	template<typename K, typename V>
+	bool insertIfAbsent(K&& k, V&& v);
+	// removes the key and value at position i of b, and merges or frees b if it gets too small
+	void eraseAt(Block* b, size_t i) noexcept;
+	// moves the upper half of a full Block into a new Block right after it.
+	// If that throws, b is left as it was.
+	void split(Block* b);
+	// moves all of next's keys and values to the end of b and frees next
+	void merge(Block* b, Block* next) noexcept;
+
+	// deep copies every Block of st into this (empty) list
+	void copyBlocks(const UnrolledSortedList & st);
+	// deletes every Block and leaves the list empty
+	void deleteBlocks() noexcept;
+
+
+	// iterates over the keys and values in order, giving a reference to each key and value
+	template<bool Const>
+	class Iterator
+	{
+	public:
+		using BlockPointer = std::conditional_t<Const, const Block*, Block*>;
+		using ValueReference = std::conditional_t<Const, const Value &, Value &>;
+
+		struct Entry
+		{
+			const Key & key;
+			ValueReference value;
+		};
+
+		using iterator_category = std::bidirectional_iterator_tag;
+		using iterator_concept = std::bidirectional_iterator_tag;
+		using value_type = Entry;
+		using difference_type = std::ptrdiff_t;
+		using reference = Entry;
+
+		Iterator() noexcept : list(nullptr), block(nullptr), position(0) {}
+		Iterator(const UnrolledSortedList* l, BlockPointer b, size_t i) noexcept : list(l), block(b), position(i) {}
+		// an iterator can always be turned into a const_iterator
+		operator Iterator<true>() const noexcept { return Iterator<true>(list, block, position); }
+
+		reference operator*() const noexcept { return Entry{block->keys()[position], block->values()[position]}; }
+
+		Iterator & operator++() noexcept
+		{
+			// Move to the start of the next Block after the last key of this one
+			if (++position == block->size)
+			{
+				block = block->next;
+				position = 0;
+			}
+			return *this;
+		}
+		Iterator operator++(int) noexcept { Iterator old = *this; ++*this; return old; }
+
+		Iterator & operator--() noexcept
+		{
+			// Moving back from the end, or from the start of a Block, goes to the last key of the Block before
+			if (block == nullptr || position == 0)
+			{
+				block = block == nullptr ? list->tail : block->prev;
+				position = block->size;
+			}
+			position--;
+			return *this;
+		}
+		Iterator operator--(int) noexcept { Iterator old = *this; --*this; return old; }
+
+		bool operator==(const Iterator & other) const noexcept { return block == other.block && position == other.position; }
+
+	private:
+		const UnrolledSortedList* list;
+		BlockPointer block;
+		size_t position;
+	};
+
+public:
+	using iterator = Iterator<false>;
+	using const_iterator = Iterator<true>;
+	using reverse_iterator = std::reverse_iterator<iterator>;
+	using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+	UnrolledSortedList();
+	explicit UnrolledSortedList(const Compare & comp, const Allocator & a = Allocator());
+	explicit UnrolledSortedList(const Allocator & a);
+
+	UnrolledSortedList(const UnrolledSortedList & st);
+	UnrolledSortedList & operator=(const UnrolledSortedList & st);
+	UnrolledSortedList(UnrolledSortedList && st) noexcept;
+	UnrolledSortedList & operator=(UnrolledSortedList && st) noexcept;
+	~UnrolledSortedList();
+
+	void swap(UnrolledSortedList & other) noexcept;
+	friend void swap(UnrolledSortedList & a, UnrolledSortedList & b) noexcept
+	{
+		a.swap(b);
+	}
+
+	Allocator get_allocator() const noexcept;
+	Compare key_comp() const;
+
+
+	size_t size() const noexcept;
+	bool isEmpty() const noexcept;
+
+	// returns the smallest (front) or largest (back) key in the list.
+	// If the list is empty, this throws a KeyNotFoundException.
+	const Key & front() const;
+	const Key & back() const;
+
+
+	// If this key is already present, return false.
+	// otherwise, return true after inserting this key/value pair.
+	bool insert(const Key &k, const Value &v);
+	bool insert(Key &&k, Value &&v);
+
+	// Return true if this list contains a mapping of this key.
+	bool contains(const Key &k) const noexcept;
+
+	// removes the given key (and its associated value) from the list.
+	// If that key is not in the list, this will silently do nothing.
+	void remove(const Key &k);
+
+	// If this key exists in the list, this function returns how many keys are in the list that are less than it.
+	// If this key does not exist in the list, this throws a KeyNotFoundException.
+	unsigned getIndex(const Key &k) const;
+
+	// If this key does not exist in the list, these throw a KeyNotFoundException.
+	Value & operator[] (const Key &k);
+	const Value & operator[] (const Key &k) const;
+
+	// returns the largest key in the list that is < the given key,
+	// or the smallest key in the list that is > the given key.
+	// If no such element exists, these throw a KeyNotFoundException.
+	const Key & largestLessThan(const Key & k) const;
+	const Key & smallestGreaterThan(const Key & k) const;
+
+	// Two lists are equal if and only if they have the same keys, each with the same value.
+	// (They don't need to be split into Blocks the same way.)
+	bool operator==(const UnrolledSortedList & l) const noexcept;
+
+	// preincrement every Value (not key) in the list.
+	void operator++();
+
+
+	// iterators over the keys and values in order. *it gives a struct with key and value references.
+	iterator begin() noexcept;
+	iterator end() noexcept;
+	const_iterator begin() const noexcept;
+	const_iterator end() const noexcept;
+	const_iterator cbegin() const noexcept;
+	const_iterator cend() const noexcept;
+	reverse_iterator rbegin() noexcept;
+	reverse_iterator rend() noexcept;
+	const_reverse_iterator rbegin() const noexcept;
+	const_reverse_iterator rend() const noexcept;
+};
+
+
+template<typename Key, typename Value, size_t BlockSize, typename Compare, typename Allocator>
+typename UnrolledSortedList<Key,Value,BlockSize,Compare,Allocator>::Block* UnrolledSortedList<Key,Value,BlockSize,Compare,Allocator>::createBlockAfter(Block* b)
+{
+	// Make room in the directory first, so nothing has to be undone if that fails
+	auto position = directory.insert(b != nullptr ? positionOf(b) + 1 : directory.begin(), nullptr);
+	Block* newBlock = blockPool.allocate();
+	std::construct_at(newBlock);
+	*position = newBlock;
+	// Splice the new Block in between b and the Block after it
+	Block* next = b != nullptr ? b->next : head;
+	newBlock->prev = b;
+	newBlock->next = next;
+	(b != nullptr ? b->next : head) = newBlock;
+	(next != nullptr ? next->prev : tail) = newBlock;
+	return newBlock;
+}
+
+template<typename Key, typename Value, size_t BlockSize, typename Compare, typename Allocator>
+void UnrolledSortedList<Key,Value,BlockSize,Compare,Allocator>::destroyBlock(Block* b) noexcept
+{
+	// Connect b's neighbours to each other, then give b back to the pool
+	(b->prev != nullptr ? b->prev->next : head) = b->next;
+	(b->next != nullptr ? b->next->prev : tail) = b->prev;
+	std::destroy_at(b);
+	blockPool.deallocate(b);
+}
+
+template<typename Key, typename Value, size_t BlockSize, typename Compare, typename Allocator>
+void UnrolledSortedList<Key,Value,BlockSize,Compare,Allocator>::discardBlock(Block* b) noexcept
+{
+	// It has no last key to find it by, so look for the pointer itself
+	directory.erase(std::find(directory.begin(), directory.end(), b));
+	destroyBlock(b);
+}
+
+template<typename Key, typename Value, size_t BlockSize, typename Compare, typename Allocator>
+void UnrolledSortedList<Key,Value,BlockSize,Compare,Allocator>::replaceBlock(Block* b, Block* copy) noexcept
+{
+	*positionOf(b) = copy;
+	copy->prev = b->prev;
+	copy->next = b->next;
+	(b->prev != nullptr ? b->prev->next : head) = copy;
+	(b->next != nullptr ? b->next->prev : tail) = copy;
+	std::destroy(b->keys(), b->keys() + b->size);
+	std::destroy(b->values(), b->values() + b->size);
+	std::destroy_at(b);
+	blockPool.deallocate(b);
+}
+
+template<typename Key, typename Value, size_t BlockSize, typename Compare, typename Allocator>
+typename UnrolledSortedList<Key,Value,BlockSize,Compare,Allocator>::Directory::iterator UnrolledSortedList<Key,Value,BlockSize,Compare,Allocator>::positionOf(const Block* b) noexcept
+{
+	// Every Block's last key is different, so b is the first Block whose last key isn't less than its own
+	return std::partition_point(directory.begin(), directory.end(), [&](const Block* d)
+	{
+		return compare(d->lastKey(), b->lastKey());
+	});
+}
+
+template<typename Key, typename Value, size_t BlockSize, typename Compare, typename Allocator>
+typename UnrolledSortedList<Key,Value,BlockSize,Compare,Allocator>::Block* UnrolledSortedList<Key,Value,BlockSize,Compare,Allocator>::findBlock(const Key & k) const noexcept
+{
+	// Only the last key of each Block needs to be looked at to skip over it
+	auto position = std::partition_point(directory.begin(), directory.end(), [&](const Block* b)
+	{
+		return compare(b->lastKey(), k);
+	});
+	return position != directory.end() ? *position : nullptr;
+}
+
+template<typename Key, typename Value, size_t BlockSize, typename Compare, typename Allocator>
+typename UnrolledSortedList<Key,Value,BlockSize,Compare,Allocator>::Block* UnrolledSortedList<Key,Value,BlockSize,Compare,Allocator>::findBlockAfter(const Key & k) const noexcept
+{
+	auto position = std::partition_point(directory.begin(), directory.end(), [&](const Block* b)
+	{
+		return ! compare(k, b->lastKey());
+	});
+	return position != directory.end() ? *position : nullptr;
+}
+
+template<typename Key, typename Value, size_t BlockSize, typename Compare, typename Allocator>
+size_t UnrolledSortedList<Key,Value,BlockSize,Compare,Allocator>::lowerBound(const Block* b, const Key & k) const noexcept
+{
+	return std::lower_bound(b->keys(), b->keys() + b->size, k, compare) - b->keys();
+}
+
+template<typename Key, typename Value, size_t BlockSize, typename Compare, typename Allocator>
+bool UnrolledSortedList<Key,Value,BlockSize,Compare,Allocator>::isKeyAt(const Block* b, size_t i, const Key & k) const noexcept
+{
+	// That key is not less than k, so it is k unless k is less than it
+	return ! compare(k, b->keys()[i]);
+}
+
+template<typename Key, typename Value, size_t BlockSize, typename Compare, typename Allocator>
+template<typename T, typename X>
+void UnrolledSortedList<Key,Value,BlockSize,Compare,Allocator>::copyAround(T* out, const T* from, size_t n, size_t i, X&& x)
+{
+	size_t made = 0;
+	try
+	{
+		for (; made < i; made++)
+		{
+			std::construct_at(out + made, from[made]);
+		}
+		std::construct_at(out + made, std::forward<X>(x));
+		for (made++; made <= n; made++)
+		{
+			std::construct_at(out + made, from[made - 1]);
+		}
+	}
+	catch (...)
+	{
+		std::destroy(out, out + made);
+		throw;
+	}
+}
+
+template<typename Key, typename Value, size_t BlockSize, typename Compare, typename Allocator>
+template<typename T>
+void UnrolledSortedList<Key,Value,BlockSize,Compare,Allocator>::relocate(T* first, T* last, T* out)
+{
+	T* made = out;
+	try
+	{
+		for (; first != last; ++first, ++made)
+		{
+			std::construct_at(made, std::move_if_noexcept(*first));
+		}
+	}
+	catch (...)
+	{
+		std::destroy(out, made);
+		throw;
+	}
+}
+
+template<typename Key, typename Value, size_t BlockSize, typename Compare, typename Allocator>
+template<typename K, typename V>
+void UnrolledSortedList<Key,Value,BlockSize,Compare,Allocator>::insertAt(Block* b, size_t i, K&& k, V&& v)
+{
+	Key* keys = b->keys();
+	Value* values = b->values();
+	if (i == b->size)
+	{
+		// Appending to the Block, so nothing has to move
+		std::construct_at(keys + i, std::forward<K>(k));
+		try
+		{
+			std::construct_at(values + i, std::forward<V>(v));
+		}
+		catch (...)
+		{
+			std::destroy_at(keys + i);
+			throw;
+		}
+	}
+	else if constexpr (ShiftsInPlace)
+	{
+		// Make the new key and value first, so nothing has moved if that throws
+		Key key(std::forward<K>(k));
+		Value value(std::forward<V>(v));
+		// Then make room at i by moving everything after it up one place
+		std::construct_at(keys + b->size, std::move(keys[b->size - 1]));
+		std::construct_at(values + b->size, std::move(values[b->size - 1]));
+		std::move_backward(keys + i, keys + b->size - 1, keys + b->size);
+		std::move_backward(values + i, values + b->size - 1, values + b->size);
+		keys[i] = std::move(key);
+		values[i] = std::move(value);
+	}
+	else
+	{
+		// A move could throw with the Block half shifted, so build a copy of it with the new key and value
+		// in place, and swap that in once it is complete
+		Block* copy = blockPool.allocate();
+		std::construct_at(copy);
+		try
+		{
+			copyAround(copy->keys(), keys, b->size, i, std::forward<K>(k));
+		}
+		catch (...)
+		{
+			std::destroy_at(copy);
+			blockPool.deallocate(copy);
+			throw;
+		}
+		try
+		{
+			copyAround(copy->values(), values, b->size, i, std::forward<V>(v));
+		}
+		catch (...)
+		{
+			std::destroy(copy->keys(), copy->keys() + b->size + 1);
+			std::destroy_at(copy);
+			blockPool.deallocate(copy);
+			throw;
+		}
+		copy->size = b->size + 1;
+		replaceBlock(b, copy);
+		count++;
+		return;
+	}
+	b->size++;
+	count++;
+}
+
+template<typename Key, typename Value, size_t BlockSize, typename Compare, typename Allocator>
+void UnrolledSortedList<Key,Value,BlockSize,Compare,Allocator>::eraseAt(Block* b, size_t i) noexcept
+{
+	// A Block that is about to lose its last key is taken out of the directory while it can still be found
+	if (b->size == 1)
+	{
+		directory.erase(positionOf(b));
+	}
+	// Close the gap at i by moving everything after it down one place
+	Key* keys = b->keys();
+	Value* values = b->values();
+	std::move(keys + i + 1, keys + b->size, keys + i);
+	std::move(values + i + 1, values + b->size, values + i);
+	b->size--;
+	std::destroy_at(keys + b->size);
+	std::destroy_at(values + b->size);
+	count--;
+
+	// An empty Block is freed, and a small one is merged into a neighbour if they fit in one Block
+	if (b->size == 0)
+	{
+		destroyBlock(b);
+	}
+	else if (b->size < MinBlockSize)
+	{
+		if (b->next != nullptr && b->size + b->next->size <= BlockSize)
+		{
+			merge(b, b->next);
+		}
+		else if (b->prev != nullptr && b->prev->size + b->size <= BlockSize)
+		{
+			merge(b->prev, b);
+		}
+	}
+}
+
+template<typename Key, typename Value, size_t BlockSize, typename Compare, typename Allocator>
+void UnrolledSortedList<Key,Value,BlockSize,Compare,Allocator>::split(Block* b)
+{
+	// The new Block takes the upper half of b
+	Block* newBlock = createBlockAfter(b);
+	size_t half = b->size / 2;
+	try
+	{
+		relocate(b->keys() + half, b->keys() + b->size, newBlock->keys());
+	}
+	catch (...)
+	{
+		discardBlock(newBlock);
+		throw;
+	}
+	try
+	{
+		relocate(b->values() + half, b->values() + b->size, newBlock->values());
+	}
+	catch (...)
+	{
+		// Keys that were moved rather than copied have to go back (which can't throw either)
+		if constexpr (std::is_nothrow_move_constructible_v<Key>)
+		{
+			std::move(newBlock->keys(), newBlock->keys() + b->size - half, b->keys() + half);
+		}
+		std::destroy(newBlock->keys(), newBlock->keys() + b->size - half);
+		discardBlock(newBlock);
+		throw;
+	}
+	std::destroy(b->keys() + half, b->keys() + b->size);
+	std::destroy(b->values() + half, b->values() + b->size);
+	newBlock->size = b->size - half;
+	b->size = half;
+}
+
+template<typename Key, typename Value, size_t BlockSize, typename Compare, typename Allocator>
+void UnrolledSortedList<Key,Value,BlockSize,Compare,Allocator>::merge(Block* b, Block* next) noexcept
+{
+	// Take next out of the directory while it still has its keys to find it by
+	directory.erase(positionOf(next));
+	std::uninitialized_move(next->keys(), next->keys() + next->size, b->keys() + b->size);
+	std::uninitialized_move(next->values(), next->values() + next->size, b->values() + b->size);
+	std::destroy(next->keys(), next->keys() + next->size);
+	std::destroy(next->values(), next->values() + next->size);
+	b->size += next->size;
+	next->size = 0;
+	destroyBlock(next);
+}
+
+template<typename Key, typename Value, size_t BlockSize, typename Compare, typename Allocator>
+void UnrolledSortedList<Key,Value,BlockSize,Compare,Allocator>::copyBlocks(const UnrolledSortedList & st)
+{
+	// Copy each Block as a whole, so the copy is split up the same way
+	for (Block* current = st.head; current != nullptr; current = current->next)
+	{
+		Block* newBlock = createBlockAfter(tail);
+		for (size_t i = 0; i < current->size; i++)
+		{
+			insertAt(newBlock, i, current->keys()[i], current->values()[i]);
+		}
+	}
+}
+
+template<typename Key, typename Value, size_t BlockSize, typename Compare, typename Allocator>
+void UnrolledSortedList<Key,Value,BlockSize,Compare,Allocator>::deleteBlocks() noexcept
+{
+	// Destroy the keys and values in every Block, then the Block
+	while (head != nullptr)
+	{
+		Block* current = head;
+		head = head->next;
+		std::destroy(current->keys(), current->keys() + current->size);
+		std::destroy(current->values(), current->values() + current->size);
+		std::destroy_at(current);
+		blockPool.deallocate(current);
+	}
+	tail = nullptr;
+	count = 0;
+	directory.clear();
+}
+
+
+template<typename Key, typename Value, size_t BlockSize, typename Compare, typename Allocator>
+UnrolledSortedList<Key,Value,BlockSize,Compare,Allocator>::UnrolledSortedList()
+	: head(nullptr), tail(nullptr), count(0), compare()
+{}
+
+template<typename Key, typename Value, size_t BlockSize, typename Compare, typename Allocator>
+UnrolledSortedList<Key,Value,BlockSize,Compare,Allocator>::UnrolledSortedList(const Compare & comp, const Allocator & a)
+	: head(nullptr), tail(nullptr), count(0), blockPool(a), directory(a), compare(comp)
+{}
+
+template<typename Key, typename Value, size_t BlockSize, typename Compare, typename Allocator>
+UnrolledSortedList<Key,Value,BlockSize,Compare,Allocator>::UnrolledSortedList(const Allocator & a)
+	: UnrolledSortedList(Compare(), a)
+{}
+
+template<typename Key, typename Value, size_t BlockSize, typename Compare, typename Allocator>
+UnrolledSortedList<Key,Value,BlockSize,Compare,Allocator>::UnrolledSortedList(const UnrolledSortedList & st)
+	: head(nullptr), tail(nullptr), count(0),
+	  blockPool(std::allocator_traits<Allocator>::select_on_container_copy_construction(st.get_allocator())),
+	  directory(blockPool.get_allocator()), compare(st.compare)
+{
+	copyBlocks(st);
+}
+
+template<typename Key, typename Value, size_t BlockSize, typename Compare, typename Allocator>
+UnrolledSortedList<Key,Value,BlockSize,Compare,Allocator> & UnrolledSortedList<Key,Value,BlockSize,Compare,Allocator>::operator=(const UnrolledSortedList & st)
+{
+	if (this != &st)
+	{
+		deleteBlocks();
+		compare = st.compare;
+		copyBlocks(st);
+	}
+	return *this;
+}
+
+template<typename Key, typename Value, size_t BlockSize, typename Compare, typename Allocator>
+UnrolledSortedList<Key,Value,BlockSize,Compare,Allocator>::UnrolledSortedList(UnrolledSortedList && st) noexcept
+	: head(st.head), tail(st.tail), count(st.count), blockPool(std::move(st.blockPool)), directory(std::move(st.directory)),
+	  compare(std::move(st.compare))
+{
+	st.directory.clear();
+	st.head = nullptr;
+	st.tail = nullptr;
+	st.count = 0;
+}
+
+template<typename Key, typename Value, size_t BlockSize, typename Compare, typename Allocator>
+UnrolledSortedList<Key,Value,BlockSize,Compare,Allocator> & UnrolledSortedList<Key,Value,BlockSize,Compare,Allocator>::operator=(UnrolledSortedList && st) noexcept
+{
+	// Take st's Blocks, and let the temporary delete the ones this list had
+	UnrolledSortedList moved(std::move(st));
+	swap(moved);
+	return *this;
+}
+
+template<typename Key, typename Value, size_t BlockSize, typename Compare, typename Allocator>
+UnrolledSortedList<Key,Value,BlockSize,Compare,Allocator>::~UnrolledSortedList()
+{
+	deleteBlocks();
+}
+
+template<typename Key, typename Value, size_t BlockSize, typename Compare, typename Allocator>
+void UnrolledSortedList<Key,Value,BlockSize,Compare,Allocator>::swap(UnrolledSortedList & other) noexcept
+{
+	using std::swap;
+	swap(head, other.head);
+	swap(tail, other.tail);
+	swap(count, other.count);
+	blockPool.swap(other.blockPool);
+	directory.swap(other.directory);
+	swap(compare, other.compare);
+}
+
+template<typename Key, typename Value, size_t BlockSize, typename Compare, typename Allocator>
+Allocator UnrolledSortedList<Key,Value,BlockSize,Compare,Allocator>::get_allocator() const noexcept
+{
+	return blockPool.get_allocator();
+}
+
+template<typename Key, typename Value, size_t BlockSize, typename Compare, typename Allocator>
+Compare UnrolledSortedList<Key,Value,BlockSize,Compare,Allocator>::key_comp() const
+{
+	return compare;
+}
+
+
+template<typename Key, typename Value, size_t BlockSize, typename Compare, typename Allocator>
+size_t UnrolledSortedList<Key,Value,BlockSize,Compare,Allocator>::size() const noexcept
+{
+	return count;
+}
+
+template<typename Key, typename Value, size_t BlockSize, typename Compare, typename Allocator>
+bool UnrolledSortedList<Key,Value,BlockSize,Compare,Allocator>::isEmpty() const noexcept
+{
+	return count == 0;
+}
+
+template<typename Key, typename Value, size_t BlockSize, typename Compare, typename Allocator>
+const Key & UnrolledSortedList<Key,Value,BlockSize,Compare,Allocator>::front() const
+{
+	// Blocks are never empty, so the smallest key is the first key of the head
+	if (head != nullptr)
+	{
+		return head->keys()[0];
+	}
+	throw KeyNotFoundException{"List is empty"};
+}
+
+template<typename Key, typename Value, size_t BlockSize, typename Compare, typename Allocator>
+const Key & UnrolledSortedList<Key,Value,BlockSize,Compare,Allocator>::back() const
+{
+	if (tail != nullptr)
+	{
+		return tail->lastKey();
+	}
+	throw KeyNotFoundException{"List is empty"};
+}
+
+
+template<typename Key, typename Value, size_t BlockSize, typename Compare, typename Allocator>
+template<typename K, typename V>
+bool UnrolledSortedList<Key,Value,BlockSize,Compare,Allocator>::insertIfAbsent(K&& k, V&& v)
+{
+	// Nothing is copied or moved until the search has shown the key is new, so a duplicate costs only the search.
+	// A key larger than every other key goes at the end of the tail
+	Block* b = findBlock(k);
+	size_t i;
+	if (b == nullptr)
+	{
+		b = tail != nullptr ? tail : createBlockAfter(nullptr);
+		i = b->size;
+	}
+	else
+	{
+		// Otherwise it goes in the first Block that has a key >= k
+		i = lowerBound(b, k);
+		if (isKeyAt(b, i, k))
+		{
+			return false;
+		}
+	}
+
+	// Make room by splitting a full Block, then insert into whichever half the key belongs in
+	if (b->size == BlockSize)
+	{
+		split(b);
+		if (i > b->size)
+		{
+			i -= b->size;
+			b = b->next;
+		}
+	}
+	try
+	{
+		insertAt(b, i, std::forward<K>(k), std::forward<V>(v));
+	}
+	catch (...)
+	{
+		// A Block made for this key can't be left in the list empty, where nothing could find it by its last key
+		if (b->size == 0)
+		{
+			discardBlock(b);
+		}
+		throw;
+	}
+	return true;
+}
+
+template<typename Key, typename Value, size_t BlockSize, typename Compare, typename Allocator>
+bool UnrolledSortedList<Key,Value,BlockSize,Compare,Allocator>::insert(const Key &k, const Value &v)
+{
+	return insertIfAbsent(k, v);
+}
+
+template<typename Key, typename Value, size_t BlockSize, typename Compare, typename Allocator>
+bool UnrolledSortedList<Key,Value,BlockSize,Compare,Allocator>::insert(Key &&k, Value &&v)
+{
+	return insertIfAbsent(std::move(k), std::move(v));
+}
+
+template<typename Key, typename Value, size_t BlockSize, typename Compare, typename Allocator>
+bool UnrolledSortedList<Key,Value,BlockSize,Compare,Allocator>::contains(const Key &k) const noexcept
+{
+	Block* b = findBlock(k);
+	return b != nullptr && isKeyAt(b, lowerBound(b, k), k);
+}
+
+template<typename Key, typename Value, size_t BlockSize, typename Compare, typename Allocator>
+void UnrolledSortedList<Key,Value,BlockSize,Compare,Allocator>::remove(const Key &k)
+{
+	Block* b = findBlock(k);
+	if (b != nullptr)
+	{
+		size_t i = lowerBound(b, k);
+		if (isKeyAt(b, i, k))
+		{
+			eraseAt(b, i);
+		}
+	}
+}
+
+template<typename Key, typename Value, size_t BlockSize, typename Compare, typename Allocator>
+unsigned UnrolledSortedList<Key,Value,BlockSize,Compare,Allocator>::getIndex(const Key &k) const
+{
+	// Add up the sizes of the Blocks before the one that would have the key
+	size_t index = 0;
+	Block* current = findBlock(k);
+	for (Block* before = head; before != current; before = before->next)
+	{
+		index += before->size;
+	}
+	if (current != nullptr)
+	{
+		size_t i = lowerBound(current, k);
+		if (isKeyAt(current, i, k))
+		{
+			return index + i;
+		}
+	}
+	throw KeyNotFoundException{"Key not found in list"};
+}
+
+template<typename Key, typename Value, size_t BlockSize, typename Compare, typename Allocator>
+Value & UnrolledSortedList<Key,Value,BlockSize,Compare,Allocator>::operator[] (const Key &k)
+{
+	Block* b = findBlock(k);
+	if (b != nullptr)
+	{
+		size_t i = lowerBound(b, k);
+		if (isKeyAt(b, i, k))
+		{
+			return b->values()[i];
+		}
+	}
+	throw KeyNotFoundException{"Key not found in list"};
+}
+
+template<typename Key, typename Value, size_t BlockSize, typename Compare, typename Allocator>
+const Value & UnrolledSortedList<Key,Value,BlockSize,Compare,Allocator>::operator[] (const Key &k) const
+{
+	Block* b = findBlock(k);
+	if (b != nullptr)
+	{
+		size_t i = lowerBound(b, k);
+		if (isKeyAt(b, i, k))
+		{
+			return b->values()[i];
+		}
+	}
+	throw KeyNotFoundException{"Key not found in list"};
+}
+
+template<typename Key, typename Value, size_t BlockSize, typename Compare, typename Allocator>
+const Key & UnrolledSortedList<Key,Value,BlockSize,Compare,Allocator>::largestLessThan(const Key & k) const
+{
+	// The answer is just before the first key that is >= k
+	Block* b = findBlock(k);
+	if (b == nullptr)
+	{
+		b = tail;
+	}
+	else
+	{
+		size_t i = lowerBound(b, k);
+		if (i > 0)
+		{
+			return b->keys()[i - 1];
+		}
+		b = b->prev;
+	}
+	// If that key is the first of its Block, the answer is the last key of the Block before it
+	if (b != nullptr)
+	{
+		return b->lastKey();
+	}
+	throw KeyNotFoundException{"Key not found in list"};
+}
+
+template<typename Key, typename Value, size_t BlockSize, typename Compare, typename Allocator>
+const Key & UnrolledSortedList<Key,Value,BlockSize,Compare,Allocator>::smallestGreaterThan(const Key & k) const
+{
+	// The first Block whose last key is > k has the answer
+	Block* b = findBlockAfter(k);
+	if (b != nullptr)
+	{
+		return *std::upper_bound(b->keys(), b->keys() + b->size, k, compare);
+	}
+	throw KeyNotFoundException{"Key not found in list"};
+}
+
+template<typename Key, typename Value, size_t BlockSize, typename Compare, typename Allocator>
+bool UnrolledSortedList<Key,Value,BlockSize,Compare,Allocator>::operator==(const UnrolledSortedList & l) const noexcept
+{
+	if (count != l.count)
+	{
+		return false;
+	}
+	// Walk both lists a Block at a time; they can be split up differently, so compare
+	// as many keys and values as both current Blocks still have
+	Block* current = head;
+	Block* currentl = l.head;
+	size_t i = 0;
+	size_t il = 0;
+	while (current != nullptr)
+	{
+		size_t n = std::min(current->size - i, currentl->size - il);
+		if (! std::equal(current->keys() + i, current->keys() + i + n, currentl->keys() + il) ||
+			! std::equal(current->values() + i, current->values() + i + n, currentl->values() + il))
+		{
+			return false;
+		}
+		i += n;
+		il += n;
+		if (i == current->size)
+		{
+			current = current->next;
+			i = 0;
+		}
+		if (il == currentl->size)
+		{
+			currentl = currentl->next;
+			il = 0;
+		}
+	}
+	return true;
+}
+
+template<typename Key, typename Value, size_t BlockSize, typename Compare, typename Allocator>
+void UnrolledSortedList<Key,Value,BlockSize,Compare,Allocator>::operator++()
+{
+	for (Block* current = head; current != nullptr; current = current->next)
+	{
+		for (size_t i = 0; i < current->size; i++)
+		{
+			current->values()[i]++;
+		}
+	}
+}
+
+
+template<typename Key, typename Value, size_t BlockSize, typename Compare, typename Allocator>
+typename UnrolledSortedList<Key,Value,BlockSize,Compare,Allocator>::iterator UnrolledSortedList<Key,Value,BlockSize,Compare,Allocator>::begin() noexcept
+{
+	return iterator(this, head, 0);
+}
+
+template<typename Key, typename Value, size_t BlockSize, typename Compare, typename Allocator>
+typename UnrolledSortedList<Key,Value,BlockSize,Compare,Allocator>::iterator UnrolledSortedList<Key,Value,BlockSize,Compare,Allocator>::end() noexcept
+{
+	return iterator(this, nullptr, 0);
+}
+
+template<typename Key, typename Value, size_t BlockSize, typename Compare, typename Allocator>
+typename UnrolledSortedList<Key,Value,BlockSize,Compare,Allocator>::const_iterator UnrolledSortedList<Key,Value,BlockSize,Compare,Allocator>::begin() const noexcept
+{
+	return const_iterator(this, head, 0);
+}
+
+template<typename Key, typename Value, size_t BlockSize, typename Compare, typename Allocator>
+typename UnrolledSortedList<Key,Value,BlockSize,Compare,Allocator>::const_iterator UnrolledSortedList<Key,Value,BlockSize,Compare,Allocator>::end() const noexcept
+{
+	return const_iterator(this, nullptr, 0);
+}
+
+template<typename Key, typename Value, size_t BlockSize, typename Compare, typename Allocator>
+typename UnrolledSortedList<Key,Value,BlockSize,Compare,Allocator>::const_iterator UnrolledSortedList<Key,Value,BlockSize,Compare,Allocator>::cbegin() const noexcept
+{
+	return begin();
+}
+
+template<typename Key, typename Value, size_t BlockSize, typename Compare, typename Allocator>
+typename UnrolledSortedList<Key,Value,BlockSize,Compare,Allocator>::const_iterator UnrolledSortedList<Key,Value,BlockSize,Compare,Allocator>::cend() const noexcept
+{
+	return end();
+}
+
+template<typename Key, typename Value, size_t BlockSize, typename Compare, typename Allocator>
+typename UnrolledSortedList<Key,Value,BlockSize,Compare,Allocator>::reverse_iterator UnrolledSortedList<Key,Value,BlockSize,Compare,Allocator>::rbegin() noexcept
+{
+	return reverse_iterator(end());
+}
+
+template<typename Key, typename Value, size_t BlockSize, typename Compare, typename Allocator>
+typename UnrolledSortedList<Key,Value,BlockSize,Compare,Allocator>::reverse_iterator UnrolledSortedList<Key,Value,BlockSize,Compare,Allocator>::rend() noexcept
+{
+	return reverse_iterator(begin());
+}
+
+template<typename Key, typename Value, size_t BlockSize, typename Compare, typename Allocator>
+typename UnrolledSortedList<Key,Value,BlockSize,Compare,Allocator>::const_reverse_iterator UnrolledSortedList<Key,Value,BlockSize,Compare,Allocator>::rbegin() const noexcept
+{
+	return const_reverse_iterator(end());
+}
+
+template<typename Key, typename Value, size_t BlockSize, typename Compare, typename Allocator>
+typename UnrolledSortedList<Key,Value,BlockSize,Compare,Allocator>::const_reverse_iterator UnrolledSortedList<Key,Value,BlockSize,Compare,Allocator>::rend() const noexcept
+{
+	return const_reverse_iterator(begin());
+}
+
+
+#endif
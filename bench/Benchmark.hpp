@@ -0,0 +1,80 @@
+#ifndef __BENCHMARK_HPP
+#define __BENCHMARK_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+// how many times operator new has been called so far (counted in bench/main.cpp)
+size_t allocationCount() noexcept;
+
+
+// What a benchmark function is given: the size to run at, and somewhere to put the result.
+class BenchmarkState
+{
+public:
+	explicit BenchmarkState(size_t size) : n(size), nsPerOp(0), allocationsPerOp(0) {}
+
+	// the size of the container being benchmarked
+	size_t size() const noexcept { return n; }
+
+	// Runs body, which does ops operations, and records how long each operation took
+	// and how many allocations each did. Only what happens inside body is measured,
+	// so the benchmark can set up its container before calling this.
+	template<typename F>
+	void measure(size_t ops, F && body)
+	{
+		size_t allocationsBefore = allocationCount();
+		auto start = std::chrono::steady_clock::now();
+		body();
+		auto end = std::chrono::steady_clock::now();
+		size_t allocations = allocationCount() - allocationsBefore;
+		nsPerOp = std::chrono::duration<double, std::nano>(end - start).count() / ops;
+		allocationsPerOp = static_cast<double>(allocations) / ops;
+	}
+
+	double nanosecondsPerOp() const noexcept { return nsPerOp; }
+	double allocationsPerOperation() const noexcept { return allocationsPerOp; }
+
+private:
+	size_t n;
+	double nsPerOp;
+	double allocationsPerOp;
+};
+
+using BenchmarkFunction = void (*)(BenchmarkState &);
+
+// Adds a benchmark that will be run once for each of the sizes.
+// Returns true, so it can be used to initialize a variable at namespace scope.
+bool registerBenchmark(const std::string & name, BenchmarkFunction f, const std::vector<size_t> & sizes);
+
+
+// keeps the results of lookups, so the compiler can't leave the lookups out
+inline volatile unsigned sink;
+
+
+// the keys 0 .. n - 1 in a shuffled order that is the same every run
+inline std::vector<unsigned> shuffledKeys(size_t n)
+{
+	std::vector<unsigned> keys(n);
+	std::uint64_t seed = 88172645463325252ull;
+	for (size_t i = 0; i < n; i++)
+	{
+		keys[i] = static_cast<unsigned>(i);
+	}
+	for (size_t i = n; i > 1; i--)
+	{
+		seed ^= seed << 13;
+		seed ^= seed >> 7;
+		seed ^= seed << 17;
+		std::swap(keys[i - 1], keys[seed % i]);
+	}
+	return keys;
+}
+
+
+#endif
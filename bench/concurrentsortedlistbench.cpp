@@ -0,0 +1,113 @@
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Benchmark.hpp"
+#include "ConcurrentSortedList.hpp"
+#include "LockFreeSortedList.hpp"
+#include "ShardedSortedList.hpp"
+#include "SortedList.hpp"
+
+
+// Throughput of a list shared between threads. Here the size is the number of threads:
+// each one does OpsPerThread operations on a shared list of ListSize keys, and the time reported
+// is the wall-clock time divided by every thread's operations, so it goes down as threads are added
+// only if they really run at once.
+namespace
+{
+
+constexpr size_t ListSize = 100000;
+constexpr size_t OpsPerThread = 200000;
+
+// what the services do today: one std::mutex around every call
+class MutexSortedList
+{
+public:
+	bool insert(unsigned k, unsigned v)
+	{
+		std::lock_guard lock(mutex);
+		return list.insert(k, v);
+	}
+
+	void remove(unsigned k)
+	{
+		std::lock_guard lock(mutex);
+		list.remove(k);
+	}
+
+	bool contains(unsigned k) const
+	{
+		std::lock_guard lock(mutex);
+		return list.contains(k);
+	}
+
+private:
+	mutable std::mutex mutex;
+	SortedList<unsigned, unsigned> list;
+};
+
+
+// Every thread looks up random keys, and one operation in writeEvery is an insert or remove instead
+template<typename List, unsigned writeEvery>
+void sharedList(BenchmarkState & state)
+{
+	std::vector<unsigned> keys = shuffledKeys(ListSize * 2);
+	List l;
+	for (unsigned k : keys)
+	{
+		if (k % 2 == 0)
+		{
+			l.insert(k, k);
+		}
+	}
+	state.measure(state.size() * OpsPerThread, [&]()
+	{
+		// Each thread keeps its own result, since sink can only be written by one thread
+		std::vector<unsigned> results(state.size());
+		std::vector<std::thread> threads;
+		for (size_t t = 0; t < state.size(); t++)
+		{
+			threads.emplace_back([&l, &keys, &results, t]()
+			{
+				unsigned found = 0;
+				for (size_t i = 0; i < OpsPerThread; i++)
+				{
+					unsigned k = keys[(i * 7 + t * 7919) % keys.size()];
+					if (i % writeEvery != 0)
+					{
+						found += l.contains(k);
+					}
+					// The odd keys come and go; the even ones that readers mostly hit stay
+					else if (i / writeEvery % 2 == 0)
+					{
+						l.insert(k | 1, k);
+					}
+					else
+					{
+						l.remove(k | 1);
+					}
+				}
+				results[t] = found;
+			});
+		}
+		for (std::thread & thread : threads)
+		{
+			thread.join();
+		}
+		for (unsigned found : results)
+		{
+			sink = found;
+		}
+	});
+}
+
+[[maybe_unused]] bool registered =
+	registerBenchmark("MutexSortedList/ReadMostly", sharedList<MutexSortedList, 20>, {1, 2, 4, 8}) &&
+	registerBenchmark("ConcurrentSortedList/ReadMostly", sharedList<ConcurrentSortedList<unsigned, unsigned>, 20>, {1, 2, 4, 8}) &&
+	registerBenchmark("MutexSortedList/ReadWrite", sharedList<MutexSortedList, 2>, {1, 2, 4, 8}) &&
+	registerBenchmark("ConcurrentSortedList/ReadWrite", sharedList<ConcurrentSortedList<unsigned, unsigned>, 2>, {1, 2, 4, 8}) &&
+	registerBenchmark("LockFreeSortedList/ReadMostly", sharedList<LockFreeSortedList<unsigned, unsigned>, 20>, {1, 2, 4, 8}) &&
+	registerBenchmark("LockFreeSortedList/ReadWrite", sharedList<LockFreeSortedList<unsigned, unsigned>, 2>, {1, 2, 4, 8}) &&
+	registerBenchmark("ShardedSortedList/ReadMostly", sharedList<ShardedSortedList<unsigned, unsigned>, 20>, {1, 2, 4, 8}) &&
+	registerBenchmark("ShardedSortedList/ReadWrite", sharedList<ShardedSortedList<unsigned, unsigned>, 2>, {1, 2, 4, 8});
+
+}
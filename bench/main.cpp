@@ -0,0 +1,88 @@
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+#include "Benchmark.hpp"
+
+
+namespace
+{
+	// atomic, since the concurrent benchmarks allocate from several threads at once
+	std::atomic<size_t> allocations = 0;
+
+	struct RegisteredBenchmark
+	{
+		std::string name;
+		BenchmarkFunction function;
+		std::vector<size_t> sizes;
+	};
+
+	// constructed on first use, because benchmarks register themselves during static initialization
+	std::vector<RegisteredBenchmark> & registry()
+	{
+		static std::vector<RegisteredBenchmark> benchmarks;
+		return benchmarks;
+	}
+}
+
+
+// Every allocation in the program goes through here, so benchmarks can report allocations per op
+void * operator new(size_t size)
+{
+	allocations.fetch_add(1, std::memory_order_relaxed);
+	if (void * p = std::malloc(size == 0 ? 1 : size))
+	{
+		return p;
+	}
+	throw std::bad_alloc{};
+}
+
+void operator delete(void * p) noexcept
+{
+	std::free(p);
+}
+
+void operator delete(void * p, size_t) noexcept
+{
+	std::free(p);
+}
+
+
+size_t allocationCount() noexcept
+{
+	return allocations.load(std::memory_order_relaxed);
+}
+
+bool registerBenchmark(const std::string & name, BenchmarkFunction f, const std::vector<size_t> & sizes)
+{
+	registry().push_back(RegisteredBenchmark{name, f, sizes});
+	return true;
+}
+
+
+// Runs every benchmark whose name contains the first argument (or all of them if there is none)
+int main(int argc, char ** argv)
+{
+	std::string filter = argc > 1 ? argv[1] : "";
+
+	std::printf("%-48s %14s %14s\n", "Benchmark", "ns/op", "allocs/op");
+	std::printf("%s\n", std::string(78, '-').c_str());
+	for (const RegisteredBenchmark & benchmark : registry())
+	{
+		if (benchmark.name.find(filter) == std::string::npos)
+		{
+			continue;
+		}
+		for (size_t size : benchmark.sizes)
+		{
+			BenchmarkState state(size);
+			benchmark.function(state);
+			std::string name = benchmark.name + "/" + std::to_string(size);
+			std::printf("%-48s %14.1f %14.3f\n", name.c_str(), state.nanosecondsPerOp(), state.allocationsPerOperation());
+			std::fflush(stdout);
+		}
+	}
+	return 0;
+}
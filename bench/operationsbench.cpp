@@ -0,0 +1,310 @@
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <string>
+#include <vector>
+#include "Benchmark.hpp"
+#include "PersistentSortedList.hpp"
+#include "SortedList.hpp"
+#include "UnrolledSortedList.hpp"
+
+
+// The same operations on SortedList, UnrolledSortedList, PersistentSortedList and std::map (as a baseline).
+// A list of size n holds the even keys 0, 2, .. 2n - 2, so odd keys are misses.
+// Lookups are timed over at most MaxProbes random keys, so the largest sizes don't take all day.
+namespace
+{
+
+using Linked = SortedList<unsigned, unsigned>;
+using Unrolled = UnrolledSortedList<unsigned, unsigned>;
+using Persistent = PersistentSortedList<unsigned, unsigned>;
+using Map = std::map<unsigned, unsigned>;
+
+constexpr size_t MaxProbes = 100000;
+// Copies are repeated until about this many keys have been copied, so a small list is timed over many copies
+constexpr size_t CopiedKeys = 1000000;
+
+
+// std::map spells some of the operations differently, so every operation goes through one of these
+template<typename List>
+bool insertKey(List & l, unsigned k)
+{
+	return l.insert(k, k);
+}
+
+bool insertKey(Map & m, unsigned k)
+{
+	return m.emplace(k, k).second;
+}
+
+template<typename List>
+void removeKey(List & l, unsigned k)
+{
+	l.remove(k);
+}
+
+void removeKey(Map & m, unsigned k)
+{
+	m.erase(k);
+}
+
+template<typename List>
+unsigned valueOf(List & l, unsigned k)
+{
+	return l[k];
+}
+
+unsigned valueOf(Map & m, unsigned k)
+{
+	return m.at(k);
+}
+
+template<typename List>
+unsigned keyBefore(const List & l, unsigned k)
+{
+	return l.largestLessThan(k);
+}
+
+unsigned keyBefore(const Map & m, unsigned k)
+{
+	return std::prev(m.lower_bound(k))->first;
+}
+
+
+// a list of size n, built in increasing order (which every container does quickly)
+template<typename List>
+void fill(List & l, size_t n)
+{
+	for (size_t i = 0; i < n; i++)
+	{
+		insertKey(l, static_cast<unsigned>(i * 2));
+	}
+}
+
+// up to MaxProbes of the indexes 0 .. n - 1, in a shuffled order
+std::vector<unsigned> probes(size_t n)
+{
+	std::vector<unsigned> indexes = shuffledKeys(n);
+	indexes.resize(std::min(n, MaxProbes));
+	return indexes;
+}
+
+
+template<typename List>
+void insertRandom(BenchmarkState & state)
+{
+	std::vector<unsigned> keys = shuffledKeys(state.size());
+	List l;
+	state.measure(keys.size(), [&]()
+	{
+		for (unsigned k : keys)
+		{
+			insertKey(l, k * 2);
+		}
+	});
+}
+
+template<typename List>
+void insertAscending(BenchmarkState & state)
+{
+	List l;
+	state.measure(state.size(), [&]()
+	{
+		for (size_t i = 0; i < state.size(); i++)
+		{
+			insertKey(l, static_cast<unsigned>(i * 2));
+		}
+	});
+}
+
+template<typename List>
+void insertDescending(BenchmarkState & state)
+{
+	List l;
+	state.measure(state.size(), [&]()
+	{
+		for (size_t i = state.size(); i > 0; i--)
+		{
+			insertKey(l, static_cast<unsigned>(i * 2 - 2));
+		}
+	});
+}
+
+template<typename List>
+void containsHit(BenchmarkState & state)
+{
+	List l;
+	fill(l, state.size());
+	std::vector<unsigned> indexes = probes(state.size());
+	state.measure(indexes.size(), [&]()
+	{
+		for (unsigned i : indexes)
+		{
+			sink = l.contains(i * 2);
+		}
+	});
+}
+
+template<typename List>
+void containsMiss(BenchmarkState & state)
+{
+	List l;
+	fill(l, state.size());
+	std::vector<unsigned> indexes = probes(state.size());
+	state.measure(indexes.size(), [&]()
+	{
+		for (unsigned i : indexes)
+		{
+			sink = l.contains(i * 2 + 1);
+		}
+	});
+}
+
+template<typename List>
+void removeKeys(BenchmarkState & state)
+{
+	List l;
+	fill(l, state.size());
+	std::vector<unsigned> indexes = probes(state.size());
+	state.measure(indexes.size(), [&]()
+	{
+		for (unsigned i : indexes)
+		{
+			removeKey(l, i * 2);
+		}
+	});
+}
+
+template<typename List>
+void getIndex(BenchmarkState & state)
+{
+	List l;
+	fill(l, state.size());
+	std::vector<unsigned> indexes = probes(state.size());
+	state.measure(indexes.size(), [&]()
+	{
+		for (unsigned i : indexes)
+		{
+			sink = l.getIndex(i * 2);
+		}
+	});
+}
+
+template<typename List>
+void subscript(BenchmarkState & state)
+{
+	List l;
+	fill(l, state.size());
+	std::vector<unsigned> indexes = probes(state.size());
+	state.measure(indexes.size(), [&]()
+	{
+		for (unsigned i : indexes)
+		{
+			sink = valueOf(l, i * 2);
+		}
+	});
+}
+
+// looks for the key before each odd key, which is always there
+template<typename List>
+void largestLessThan(BenchmarkState & state)
+{
+	List l;
+	fill(l, state.size());
+	std::vector<unsigned> indexes = probes(state.size());
+	state.measure(indexes.size(), [&]()
+	{
+		for (unsigned i : indexes)
+		{
+			sink = keyBefore(l, i * 2 + 1);
+		}
+	});
+}
+
+// how many copies of a list of size n to time
+size_t copies(size_t n)
+{
+	return std::max<size_t>(1, CopiedKeys / n);
+}
+
+// copies a list of size n, timed per copy (a SortedList or PersistentSortedList copy shares its Nodes,
+// so that is O(1); the others copy every key)
+template<typename List>
+void copyList(BenchmarkState & state)
+{
+	List l;
+	fill(l, state.size());
+	size_t n = copies(state.size());
+	state.measure(n, [&]()
+	{
+		for (size_t i = 0; i < n; i++)
+		{
+			List copied(l);
+			sink = static_cast<unsigned>(copied.size());
+		}
+	});
+}
+
+// copies a list of size n and inserts a key into the copy, which is when a SortedList copies its Nodes
+// (a PersistentSortedList copies only the Nodes on the way to the new key)
+template<typename List>
+void copyAndInsert(BenchmarkState & state)
+{
+	List l;
+	fill(l, state.size());
+	size_t n = copies(state.size());
+	state.measure(n, [&]()
+	{
+		for (size_t i = 0; i < n; i++)
+		{
+			List copied(l);
+			insertKey(copied, 1);
+			sink = static_cast<unsigned>(copied.size());
+		}
+	});
+}
+
+// compares two equal lists that were built separately, timed per key compared
+template<typename List>
+void equality(BenchmarkState & state)
+{
+	List l;
+	List p;
+	fill(l, state.size());
+	fill(p, state.size());
+	state.measure(state.size(), [&]()
+	{
+		sink = l == p;
+	});
+}
+
+
+// registers every operation for one container, under name
+template<typename List>
+bool registerOperations(const std::string & name, const std::vector<size_t> & sizes)
+{
+	return registerBenchmark(name + "/InsertRandom", insertRandom<List>, sizes) &&
+		registerBenchmark(name + "/InsertAscending", insertAscending<List>, sizes) &&
+		registerBenchmark(name + "/InsertDescending", insertDescending<List>, sizes) &&
+		registerBenchmark(name + "/ContainsHit", containsHit<List>, sizes) &&
+		registerBenchmark(name + "/ContainsMiss", containsMiss<List>, sizes) &&
+		registerBenchmark(name + "/Remove", removeKeys<List>, sizes) &&
+		registerBenchmark(name + "/Subscript", subscript<List>, sizes) &&
+		registerBenchmark(name + "/LargestLessThan", largestLessThan<List>, sizes) &&
+		registerBenchmark(name + "/Copy", copyList<List>, sizes) &&
+		registerBenchmark(name + "/CopyAndInsert", copyAndInsert<List>, sizes) &&
+		registerBenchmark(name + "/Equality", equality<List>, sizes);
+}
+
+// UnrolledSortedList's directory of Blocks is a vector, so it stops at 1e6
+// (std::map has no getIndex: finding a key's index in one takes a walk from begin())
+[[maybe_unused]] bool registered =
+	registerOperations<Linked>("SortedList", {100, 10000, 1000000, 10000000}) &&
+	registerBenchmark("SortedList/GetIndex", getIndex<Linked>, {100, 10000, 1000000, 10000000}) &&
+	registerOperations<Unrolled>("UnrolledSortedList", {100, 10000, 1000000}) &&
+	registerBenchmark("UnrolledSortedList/GetIndex", getIndex<Unrolled>, {100, 10000, 1000000}) &&
+	registerOperations<Persistent>("PersistentSortedList", {100, 10000, 1000000}) &&
+	registerBenchmark("PersistentSortedList/GetIndex", getIndex<Persistent>, {100, 10000, 1000000}) &&
+	registerOperations<Map>("StdMap", {100, 10000, 1000000, 10000000});
+
+}
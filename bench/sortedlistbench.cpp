@@ -0,0 +1,382 @@
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+#include "Benchmark.hpp"
+#include "SortedList.hpp"
+
+
+namespace
+{
+
+// A feed where about 70% of inserts are keys that are already in the list
+void insertMostlyDuplicates(BenchmarkState & state)
+{
+	std::vector<unsigned> keys = shuffledKeys(state.size());
+	SortedList<unsigned, unsigned> l;
+	for (size_t i = 0; i < keys.size(); i++)
+	{
+		l.insert(keys[i] * 2, 0);
+	}
+	// Every key in this batch is a duplicate 7 times out of 10
+	std::vector<unsigned> feed(keys.size());
+	for (size_t i = 0; i < keys.size(); i++)
+	{
+		feed[i] = i % 10 < 7 ? keys[i] * 2 : keys[i] * 2 + 1;
+	}
+	state.measure(feed.size(), [&]()
+	{
+		for (unsigned k : feed)
+		{
+			l.insert(k, 1);
+		}
+	});
+}
+
+// Keys that come in runs of 64 around random places in the list, each one just below the one before it
+std::vector<unsigned> clusteredKeys(size_t n)
+{
+	std::vector<unsigned> anchors = shuffledKeys(n / 64 + 1);
+	std::vector<unsigned> keys;
+	for (size_t i = 0; keys.size() < n; i++)
+	{
+		for (unsigned j = 64; j > 0 && keys.size() < n; j--)
+		{
+			keys.push_back(anchors[i] * 64 + j);
+		}
+	}
+	return keys;
+}
+
+void insertClustered(BenchmarkState & state)
+{
+	std::vector<unsigned> keys = clusteredKeys(state.size());
+	SortedList<unsigned, unsigned> l;
+	state.measure(keys.size(), [&]()
+	{
+		for (unsigned k : keys)
+		{
+			l.insert(k, 0);
+		}
+	});
+}
+
+// The same keys, each inserted with the previous one as the hint
+void insertClusteredHinted(BenchmarkState & state)
+{
+	std::vector<unsigned> keys = clusteredKeys(state.size());
+	SortedList<unsigned, unsigned> l;
+	state.measure(keys.size(), [&]()
+	{
+		auto hint = l.end();
+		for (unsigned k : keys)
+		{
+			hint = l.insert(hint, k, 0);
+		}
+	});
+}
+
+// Loading n sorted pairs one insert at a time, or all at once
+void loadSortedByInsert(BenchmarkState & state)
+{
+	std::vector<std::pair<unsigned, unsigned>> pairs(state.size());
+	for (size_t i = 0; i < pairs.size(); i++)
+	{
+		pairs[i] = {static_cast<unsigned>(i), 0};
+	}
+	state.measure(pairs.size(), [&]()
+	{
+		SortedList<unsigned, unsigned> l;
+		for (const auto & [k, v] : pairs)
+		{
+			l.insert(k, v);
+		}
+	});
+}
+
+void loadSortedByRange(BenchmarkState & state)
+{
+	std::vector<std::pair<unsigned, unsigned>> pairs(state.size());
+	for (size_t i = 0; i < pairs.size(); i++)
+	{
+		pairs[i] = {static_cast<unsigned>(i), 0};
+	}
+	state.measure(pairs.size(), [&]()
+	{
+		SortedList<unsigned, unsigned> l;
+		l.assignSorted(pairs.begin(), pairs.end());
+	});
+}
+
+// Adding batches of 1000 random keys to a list of n keys, one insert at a time or a batch at a time
+std::vector<std::vector<std::pair<unsigned, unsigned>>> randomBatches(size_t n)
+{
+	std::vector<unsigned> keys = shuffledKeys(n * 2);
+	std::vector<std::vector<std::pair<unsigned, unsigned>>> batches(n / 1000);
+	for (size_t i = 0; i < n; i++)
+	{
+		batches[i / 1000].emplace_back(keys[i], 0);
+	}
+	return batches;
+}
+
+void insertBatchesOneByOne(BenchmarkState & state)
+{
+	auto batches = randomBatches(state.size());
+	SortedList<unsigned, unsigned> l;
+	state.measure(state.size(), [&]()
+	{
+		for (const auto & batch : batches)
+		{
+			for (const auto & [k, v] : batch)
+			{
+				l.insert(k, v);
+			}
+		}
+	});
+}
+
+void insertBatches(BenchmarkState & state)
+{
+	auto batches = randomBatches(state.size());
+	SortedList<unsigned, unsigned> l;
+	state.measure(state.size(), [&]()
+	{
+		for (const auto & batch : batches)
+		{
+			l.insertBatch(batch);
+		}
+	});
+}
+
+// Expiring the oldest half of a list of n keys, one remove at a time or as one range
+void expireByRemove(BenchmarkState & state)
+{
+	std::vector<std::pair<unsigned, unsigned>> pairs(state.size());
+	for (size_t i = 0; i < pairs.size(); i++)
+	{
+		pairs[i] = {static_cast<unsigned>(i), 0};
+	}
+	SortedList<unsigned, unsigned> l(pairs.begin(), pairs.end());
+	state.measure(state.size() / 2, [&]()
+	{
+		for (unsigned k = 0; k < state.size() / 2; k++)
+		{
+			l.remove(k);
+		}
+	});
+}
+
+void expireByRemoveRange(BenchmarkState & state)
+{
+	std::vector<std::pair<unsigned, unsigned>> pairs(state.size());
+	for (size_t i = 0; i < pairs.size(); i++)
+	{
+		pairs[i] = {static_cast<unsigned>(i), 0};
+	}
+	SortedList<unsigned, unsigned> l(pairs.begin(), pairs.end());
+	state.measure(state.size() / 2, [&]()
+	{
+		l.removeRange(0, static_cast<unsigned>(state.size() / 2));
+	});
+}
+
+// Looking up the next key after each of 2n probes, half of which are past the end of a list of n keys,
+// with smallestGreaterThan (which throws on a miss) or upperBound (which returns end())
+void smallestGreaterThanWithMisses(BenchmarkState & state)
+{
+	std::vector<unsigned> keys = shuffledKeys(state.size() * 2);
+	SortedList<unsigned, unsigned> l;
+	for (unsigned k : keys)
+	{
+		if (k < state.size())
+		{
+			l.insert(k, 0);
+		}
+	}
+	state.measure(keys.size(), [&]()
+	{
+		for (unsigned k : keys)
+		{
+			try
+			{
+				sink = l.smallestGreaterThan(k);
+			}
+			catch (const KeyNotFoundException &)
+			{
+			}
+		}
+	});
+}
+
+void upperBoundWithMisses(BenchmarkState & state)
+{
+	std::vector<unsigned> keys = shuffledKeys(state.size() * 2);
+	SortedList<unsigned, unsigned> l;
+	for (unsigned k : keys)
+	{
+		if (k < state.size())
+		{
+			l.insert(k, 0);
+		}
+	}
+	state.measure(keys.size(), [&]()
+	{
+		for (unsigned k : keys)
+		{
+			auto it = l.upperBound(k);
+			if (it != l.end())
+			{
+				sink = it->key;
+			}
+		}
+	});
+}
+
+// Looking up the values of 2n probes, half of which miss, with operator[] (which throws on a miss) or tryGet
+void subscriptWithMisses(BenchmarkState & state)
+{
+	std::vector<unsigned> keys = shuffledKeys(state.size() * 2);
+	SortedList<unsigned, unsigned> l;
+	for (unsigned k : keys)
+	{
+		if (k % 2 == 0)
+		{
+			l.insert(k, k);
+		}
+	}
+	state.measure(keys.size(), [&]()
+	{
+		for (unsigned k : keys)
+		{
+			try
+			{
+				sink = l[k];
+			}
+			catch (const KeyNotFoundException &)
+			{
+			}
+		}
+	});
+}
+
+void tryGetWithMisses(BenchmarkState & state)
+{
+	std::vector<unsigned> keys = shuffledKeys(state.size() * 2);
+	SortedList<unsigned, unsigned> l;
+	for (unsigned k : keys)
+	{
+		if (k % 2 == 0)
+		{
+			l.insert(k, k);
+		}
+	}
+	state.measure(keys.size(), [&]()
+	{
+		for (unsigned k : keys)
+		{
+			if (unsigned* v = l.tryGet(k))
+			{
+				sink = *v;
+			}
+		}
+	});
+}
+
+// Summing the values in windows of 100 keys at random places in a list of n keys,
+// with repeated smallestGreaterThan calls (each value is its key) or with range
+void windowBySmallestGreaterThan(BenchmarkState & state)
+{
+	std::vector<unsigned> keys = shuffledKeys(state.size());
+	SortedList<unsigned, unsigned> l;
+	for (unsigned k : keys)
+	{
+		l.insert(k, k);
+	}
+	size_t windows = keys.size() / 100;
+	state.measure(windows * 100, [&]()
+	{
+		for (size_t i = 0; i < windows; i++)
+		{
+			unsigned sum = 0;
+			unsigned k = keys[i] > 0 ? keys[i] - 1 : 0;
+			for (unsigned j = 0; j < 100 && k + 1 < keys.size(); j++)
+			{
+				k = l.smallestGreaterThan(k);
+				sum += k;
+			}
+			sink = sum;
+		}
+	});
+}
+
+void windowByRange(BenchmarkState & state)
+{
+	std::vector<unsigned> keys = shuffledKeys(state.size());
+	SortedList<unsigned, unsigned> l;
+	for (unsigned k : keys)
+	{
+		l.insert(k, k);
+	}
+	size_t windows = keys.size() / 100;
+	state.measure(windows * 100, [&]()
+	{
+		for (size_t i = 0; i < windows; i++)
+		{
+			unsigned sum = 0;
+			for (const auto & [k, v] : l.range(keys[i], keys[i] + 100))
+			{
+				sum += v;
+			}
+			sink = sum;
+		}
+	});
+}
+
+// Looking up each of n std::string keys by const char*, with a Compare that turns it into a std::string
+// first (std::less<std::string>) or one that compares it as it is (std::less<>)
+template<typename Compare>
+void lookupByPointer(BenchmarkState & state)
+{
+	std::vector<unsigned> keys = shuffledKeys(state.size());
+	// long enough that std::string has to allocate to hold one
+	std::vector<std::string> names;
+	for (unsigned k : keys)
+	{
+		names.push_back("a key too long to fit in a small string #" + std::to_string(k));
+	}
+	SortedList<std::string, unsigned, Compare> l;
+	for (const std::string & name : names)
+	{
+		l.insert(name, 0);
+	}
+	state.measure(names.size(), [&]()
+	{
+		for (const std::string & name : names)
+		{
+			sink = l.contains(name.c_str());
+		}
+	});
+}
+
+// Each pair times the same work done the old way, then with the call that was added for it
+[[maybe_unused]] bool registered =
+	registerBenchmark("SortedList/InsertMostlyDuplicates", insertMostlyDuplicates, {1000, 100000}) &&
+	registerBenchmark("SortedList/InsertClustered", insertClustered, {1000, 100000}) &&
+	registerBenchmark("SortedList/InsertClusteredHinted", insertClusteredHinted, {1000, 100000}) &&
+	registerBenchmark("SortedList/LoadSortedByInsert", loadSortedByInsert, {1000, 1000000}) &&
+	registerBenchmark("SortedList/LoadSortedByRange", loadSortedByRange, {1000, 1000000}) &&
+	registerBenchmark("SortedList/InsertBatchesOneByOne", insertBatchesOneByOne, {10000, 1000000}) &&
+	registerBenchmark("SortedList/InsertBatches", insertBatches, {10000, 1000000}) &&
+	registerBenchmark("SortedList/ExpireByRemove", expireByRemove, {1000, 200000}) &&
+	registerBenchmark("SortedList/ExpireByRemoveRange", expireByRemoveRange, {1000, 200000}) &&
+	registerBenchmark("SortedList/SmallestGreaterThanWithMisses", smallestGreaterThanWithMisses, {1000, 100000}) &&
+	registerBenchmark("SortedList/UpperBoundWithMisses", upperBoundWithMisses, {1000, 100000}) &&
+	registerBenchmark("SortedList/SubscriptWithMisses", subscriptWithMisses, {1000, 100000}) &&
+	registerBenchmark("SortedList/TryGetWithMisses", tryGetWithMisses, {1000, 100000}) &&
+	registerBenchmark("SortedList/WindowBySmallestGreaterThan", windowBySmallestGreaterThan, {10000, 1000000}) &&
+	registerBenchmark("SortedList/WindowByRange", windowByRange, {10000, 1000000}) &&
+	registerBenchmark("SortedList/LookupByPointer", lookupByPointer<std::less<std::string>>, {1000, 100000}) &&
+	registerBenchmark("SortedList/LookupByPointerTransparent", lookupByPointer<std::less<>>, {1000, 100000});
+
+}
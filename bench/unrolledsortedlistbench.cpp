@@ -0,0 +1,101 @@
+#include <stdexcept>
+#include <vector>
+#include "Benchmark.hpp"
+#include "SortedList.hpp"
+#include "UnrolledSortedList.hpp"
+
+
+// SortedList against UnrolledSortedList on lists built in a shuffled order, where a SortedList's Nodes
+// end up scattered in memory. operationsbench.cpp builds its lists in increasing order instead,
+// so these are the Shuffled* counterparts of its ContainsHit, ContainsMiss and Equality.
+namespace
+{
+
+// fills a list with the keys 0 .. size - 1, inserted in shuffled order
+template<typename List>
+void fill(List & l, const std::vector<unsigned> & keys)
+{
+	for (unsigned k : keys)
+	{
+		l.insert(k, k);
+	}
+}
+
+
+// Looks up every key once, in shuffled order
+template<typename List>
+void containsHit(BenchmarkState & state)
+{
+	std::vector<unsigned> keys = shuffledKeys(state.size());
+	List l;
+	fill(l, keys);
+	size_t found = 0;
+	state.measure(keys.size(), [&]()
+	{
+		for (unsigned k : keys)
+		{
+			found += l.contains(k);
+		}
+	});
+	if (found != keys.size())
+	{
+		throw std::logic_error{"Benchmark lost a key"};
+	}
+}
+
+// Looks up every key that falls between two keys of the list once, in shuffled order
+template<typename List>
+void containsMiss(BenchmarkState & state)
+{
+	std::vector<unsigned> keys = shuffledKeys(state.size());
+	List l;
+	for (unsigned k : keys)
+	{
+		l.insert(k * 2, k);
+	}
+	size_t found = 0;
+	state.measure(keys.size(), [&]()
+	{
+		for (unsigned k : keys)
+		{
+			found += l.contains(k * 2 + 1);
+		}
+	});
+	if (found != 0)
+	{
+		throw std::logic_error{"Benchmark found a missing key"};
+	}
+}
+
+// Compares two equal lists that were built separately
+template<typename List>
+void equality(BenchmarkState & state)
+{
+	std::vector<unsigned> keys = shuffledKeys(state.size());
+	List l;
+	List p;
+	fill(l, keys);
+	fill(p, keys);
+	bool equal = false;
+	state.measure(keys.size(), [&]()
+	{
+		equal = l == p;
+	});
+	if (! equal)
+	{
+		throw std::logic_error{"Benchmark lists differ"};
+	}
+}
+
+using Linked = SortedList<unsigned, unsigned>;
+using Unrolled = UnrolledSortedList<unsigned, unsigned>;
+
+[[maybe_unused]] bool registered =
+	registerBenchmark("SortedList/ShuffledContainsHit", containsHit<Linked>, {1000, 100000}) &&
+	registerBenchmark("UnrolledSortedList/ShuffledContainsHit", containsHit<Unrolled>, {1000, 100000}) &&
+	registerBenchmark("SortedList/ShuffledContainsMiss", containsMiss<Linked>, {1000, 100000}) &&
+	registerBenchmark("UnrolledSortedList/ShuffledContainsMiss", containsMiss<Unrolled>, {1000, 100000}) &&
+	registerBenchmark("SortedList/ShuffledEquality", equality<Linked>, {1000, 100000}) &&
+	registerBenchmark("UnrolledSortedList/ShuffledEquality", equality<Unrolled>, {1000, 100000});
+
+}
@@ -0,0 +1,119 @@
+#include "catch_amalgamated.hpp"
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ConcurrentSortedList.hpp"
+
+
+namespace{
+
+TEST_CASE("ConcurrentBasics", "[Concurrent]")
+{
+    ConcurrentSortedList<unsigned, std::string> l;
+    REQUIRE(l.isEmpty());
+    REQUIRE(l.insert(2, "Two"));
+    REQUIRE(l.insert(1, "One"));
+    REQUIRE(l.try_emplace(3, 5, 'x'));
+    REQUIRE(l.insert(2, "ShouldFail") == false);
+    REQUIRE(l.size() == 3);
+    REQUIRE(l.contains(1));
+    REQUIRE(! l.contains(4));
+    REQUIRE(l.getIndex(3) == 2);
+    REQUIRE(l[3] == "xxxxx");
+    REQUIRE(*l.tryGet(2) == "Two");
+    REQUIRE_FALSE(l.tryGet(4).has_value());
+    REQUIRE(l.largestLessThan(3) == 2);
+    REQUIRE(l.smallestGreaterThan(1) == 2);
+    REQUIRE_THROWS_AS( l[600], KeyNotFoundException );
+    REQUIRE_THROWS_AS( l.largestLessThan(1), KeyNotFoundException );
+    l.remove(2);
+    REQUIRE(! l.contains(2));
+    REQUIRE(l.removeRange(0, 2) == 1);
+    REQUIRE(l.size() == 1);
+}
+
+TEST_CASE("ConcurrentReadAndWriteRunFunctionsLocked", "[Concurrent]")
+{
+    ConcurrentSortedList<unsigned, unsigned> l;
+    l.write([](auto & list)
+    {
+        for (unsigned i = 0; i < 100; i++)
+        {
+            list.insert(i, i * 2);
+        }
+    });
+    unsigned sum = l.read([](const auto & list)
+    {
+        unsigned total = 0;
+        for (const auto & [key, value] : list.range(10, 20))
+        {
+            total += value;
+        }
+        return total;
+    });
+    REQUIRE(sum == 290);
+    SortedList<unsigned, unsigned> copy = l.snapshot();
+    l.remove(5);
+    REQUIRE(copy.contains(5));
+    REQUIRE(copy.size() == 100);
+    REQUIRE(l.size() == 99);
+}
+
+TEST_CASE("ConcurrentReadersAndWriters", "[Concurrent]")
+{
+    ConcurrentSortedList<unsigned, unsigned> l;
+    for (unsigned i = 0; i < 1000; i++)
+    {
+        l.insert(i * 2, i);
+    }
+    // writers add and remove odd keys in their own ranges while readers look up the even keys,
+    // which are never touched, so every reader must always find them
+    std::atomic<unsigned> misses = 0;
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < 4; t++)
+    {
+        threads.emplace_back([&l, t]()
+        {
+            for (unsigned round = 0; round < 3; round++)
+            {
+                for (unsigned i = t * 250; i < (t + 1) * 250; i++)
+                {
+                    l.insert(i * 2 + 1, round);
+                }
+                for (unsigned i = t * 250; i < (t + 1) * 250; i += 2)
+                {
+                    l.remove(i * 2 + 1);
+                }
+            }
+        });
+        threads.emplace_back([&l, &misses]()
+        {
+            for (unsigned round = 0; round < 5; round++)
+            {
+                for (unsigned i = 0; i < 1000; i++)
+                {
+                    if (! l.contains(i * 2) || l[i * 2] != i)
+                    {
+                        misses++;
+                    }
+                }
+            }
+        });
+    }
+    for (std::thread & thread : threads)
+    {
+        thread.join();
+    }
+    REQUIRE(misses == 0);
+    // every writer left the odd keys at odd indexes in its range
+    REQUIRE(l.size() == 1500);
+    for (unsigned i = 0; i < 1000; i++)
+    {
+        REQUIRE(l.contains(i * 2 + 1) == (i % 2 == 1));
+    }
+    REQUIRE(l.getIndex(1998) == 1498);
+}
+
+} // end namespace
@@ -0,0 +1,170 @@
+#include "catch_amalgamated.hpp"
+
+#include <atomic>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+#include "LockFreeSortedList.hpp"
+
+
+namespace{
+
+TEST_CASE("LockFreeBasics", "[LockFree]")
+{
+    LockFreeSortedList<unsigned, std::string> l;
+    REQUIRE(l.isEmpty());
+    REQUIRE(l.insert(2, "Two"));
+    REQUIRE(l.insert(1, "One"));
+    REQUIRE(l.insert(3, "Three"));
+    REQUIRE(l.insert(2, "ShouldFail") == false);
+    REQUIRE(l.size() == 3);
+    REQUIRE(l.contains(1));
+    REQUIRE(! l.contains(4));
+    REQUIRE(l[2] == "Two");
+    REQUIRE(*l.tryGet(3) == "Three");
+    REQUIRE_FALSE(l.tryGet(4).has_value());
+    REQUIRE(l.largestLessThan(3) == 2);
+    REQUIRE(l.largestLessThan(600) == 3);
+    REQUIRE(l.smallestGreaterThan(1) == 2);
+    REQUIRE(l.smallestGreaterThan(0) == 1);
+    REQUIRE_THROWS_AS( l[600], KeyNotFoundException );
+    REQUIRE_THROWS_AS( l.largestLessThan(1), KeyNotFoundException );
+    REQUIRE_THROWS_AS( l.smallestGreaterThan(3), KeyNotFoundException );
+    l.remove(2);
+    l.remove(600);
+    REQUIRE(! l.contains(2));
+    REQUIRE(l.size() == 2);
+    REQUIRE(l.largestLessThan(3) == 1);
+    REQUIRE(l.smallestGreaterThan(1) == 3);
+    REQUIRE(l.insert(2, "Again"));
+    REQUIRE(l[2] == "Again");
+}
+
+TEST_CASE("LockFreeUsesCompare", "[LockFree]")
+{
+    LockFreeSortedList<unsigned, unsigned, std::greater<unsigned>> l;
+    for (unsigned i = 0; i < 1000; i++)
+    {
+        REQUIRE(l.insert(i, i * 2));
+    }
+    REQUIRE(l.size() == 1000);
+    REQUIRE(l.largestLessThan(500) == 501);
+    REQUIRE(l.smallestGreaterThan(500) == 499);
+    for (unsigned i = 0; i < 1000; i += 2)
+    {
+        l.remove(i);
+    }
+    REQUIRE(l.size() == 500);
+    REQUIRE(l.smallestGreaterThan(501) == 499);
+    REQUIRE(l[999] == 1998);
+}
+
+TEST_CASE("LockFreeReadersAndWriters", "[LockFree]")
+{
+    LockFreeSortedList<unsigned, unsigned> l;
+    for (unsigned i = 0; i < 1000; i++)
+    {
+        l.insert(i * 2, i);
+    }
+    // as in ConcurrentReadersAndWriters: writers add and remove odd keys in their own ranges
+    // while readers look up the even keys, which are never touched
+    std::atomic<unsigned> misses = 0;
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < 4; t++)
+    {
+        threads.emplace_back([&l, t]()
+        {
+            for (unsigned round = 0; round < 3; round++)
+            {
+                for (unsigned i = t * 250; i < (t + 1) * 250; i++)
+                {
+                    l.insert(i * 2 + 1, round);
+                }
+                for (unsigned i = t * 250; i < (t + 1) * 250; i += 2)
+                {
+                    l.remove(i * 2 + 1);
+                }
+            }
+        });
+        threads.emplace_back([&l, &misses]()
+        {
+            for (unsigned round = 0; round < 5; round++)
+            {
+                for (unsigned i = 1; i < 1000; i++)
+                {
+                    if (! l.contains(i * 2) || l[i * 2] != i || l.largestLessThan(i * 2 + 1) != i * 2 ||
+                        l.smallestGreaterThan(i * 2 - 1) != i * 2)
+                    {
+                        misses++;
+                    }
+                }
+            }
+        });
+    }
+    for (std::thread & thread : threads)
+    {
+        thread.join();
+    }
+    REQUIRE(misses == 0);
+    REQUIRE(l.size() == 1500);
+    for (unsigned i = 0; i < 1000; i++)
+    {
+        REQUIRE(l.contains(i * 2 + 1) == (i % 2 == 1));
+    }
+}
+
+TEST_CASE("LockFreeRacesOnTheSameKeys", "[LockFree]")
+{
+    // Every thread inserts and removes the same few keys, so inserts and removes of one key
+    // (and the unlinking of its Nodes) race with each other all the time
+    LockFreeSortedList<unsigned, unsigned> l;
+    std::atomic<unsigned> wrong = 0;
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < 8; t++)
+    {
+        threads.emplace_back([&l, &wrong, t]()
+        {
+            for (unsigned i = 0; i < 20000; i++)
+            {
+                unsigned k = (i * 7 + t) % 16;
+                if ((i + t) % 2 == 0)
+                {
+                    l.insert(k, k * 10);
+                }
+                else
+                {
+                    l.remove(k);
+                }
+                // whoever inserted it, a key's value is always the one that goes with it
+                std::optional<unsigned> value = l.tryGet(k ^ 1);
+                if (value.has_value() && *value != (k ^ 1) * 10)
+                {
+                    wrong++;
+                }
+            }
+        });
+    }
+    for (std::thread & thread : threads)
+    {
+        thread.join();
+    }
+    REQUIRE(wrong == 0);
+    // Whatever is left must be counted right, and linked in order
+    std::vector<unsigned> left;
+    for (unsigned k = 0; k < 16; k++)
+    {
+        if (l.contains(k))
+        {
+            left.push_back(k);
+        }
+    }
+    REQUIRE(l.size() == left.size());
+    for (size_t i = 1; i < left.size(); i++)
+    {
+        REQUIRE(l.smallestGreaterThan(left[i - 1]) == left[i]);
+        REQUIRE(l.largestLessThan(left[i]) == left[i - 1]);
+    }
+}
+
+} // end namespace
@@ -0,0 +1,160 @@
+#include "catch_amalgamated.hpp"
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "PersistentSortedList.hpp"
+
+
+namespace{
+
+TEST_CASE("PersistentBasics", "[Persistent]")
+{
+    PersistentSortedList<unsigned, std::string> l;
+    REQUIRE(l.isEmpty());
+    REQUIRE(l.insert(25, "TwentyFive"));
+    REQUIRE(l.insert(1, "One"));
+    REQUIRE(l.insert(10, "Ten"));
+    REQUIRE(l.insert(25, "ShouldFail") == false);
+    REQUIRE(l.size() == 3);
+    REQUIRE(l.contains(10));
+    REQUIRE(! l.contains(20));
+    REQUIRE(l[10] == "Ten");
+    REQUIRE(*l.tryGet(1) == "One");
+    REQUIRE(l.tryGet(2) == nullptr);
+    REQUIRE(l.getIndex(1) == 0);
+    REQUIRE(l.getIndex(25) == 2);
+    REQUIRE(l.keyAt(1) == 10);
+    REQUIRE(l.largestLessThan(25) == 10);
+    REQUIRE(l.largestLessThan(10) == 1);
+    REQUIRE(l.smallestGreaterThan(1) == 10);
+    REQUIRE(l.smallestGreaterThan(10) == 25);
+    REQUIRE_THROWS_AS( l[600], KeyNotFoundException );
+    REQUIRE_THROWS_AS( l.getIndex(2), KeyNotFoundException );
+    REQUIRE_THROWS_AS( l.keyAt(3), std::out_of_range );
+    REQUIRE_THROWS_AS( l.largestLessThan(1), KeyNotFoundException );
+    REQUIRE_THROWS_AS( l.smallestGreaterThan(25), KeyNotFoundException );
+    l.remove(10);
+    l.remove(10);
+    REQUIRE(! l.contains(10));
+    REQUIRE(l.size() == 2);
+
+    PersistentSortedList<unsigned, unsigned, std::greater<unsigned>> reversed;
+    for (unsigned i = 0; i < 10; i++)
+    {
+        reversed.insert(i, i);
+    }
+    unsigned expected = 10;
+    for (const auto & [k, v] : reversed)
+    {
+        REQUIRE(k == --expected);
+        REQUIRE(v == k);
+    }
+    REQUIRE(expected == 0);
+}
+
+TEST_CASE("SnapshotsKeepTheirVersion", "[Persistent]")
+{
+    // Every version is checked against a std::map copied when it was taken
+    PersistentSortedList<unsigned, unsigned> l;
+    std::map<unsigned, unsigned> current;
+    std::vector<PersistentSortedList<unsigned, unsigned>::Snapshot> snapshots;
+    std::vector<std::map<unsigned, unsigned>> expected;
+    for (unsigned i = 0; i < 3000; i++)
+    {
+        unsigned k = (i * 7919) % 1009;
+        if (i % 3 == 2)
+        {
+            l.remove(k);
+            current.erase(k);
+        }
+        else
+        {
+            REQUIRE(l.insert(k, i) == current.emplace(k, i).second);
+        }
+        if (i % 300 == 0)
+        {
+            snapshots.push_back(l.snapshot());
+            expected.push_back(current);
+        }
+    }
+    REQUIRE(l.size() == current.size());
+    for (size_t s = 0; s < snapshots.size(); s++)
+    {
+        const auto & snapshot = snapshots[s];
+        REQUIRE(snapshot.size() == expected[s].size());
+        auto it = snapshot.begin();
+        unsigned index = 0;
+        for (const auto & [k, v] : expected[s])
+        {
+            REQUIRE(it->key == k);
+            REQUIRE(it->value == v);
+            REQUIRE(snapshot[k] == v);
+            REQUIRE(snapshot.getIndex(k) == index);
+            REQUIRE(snapshot.keyAt(index++) == k);
+            ++it;
+        }
+        REQUIRE(it == snapshot.end());
+    }
+    REQUIRE(l.snapshot() == l);
+    REQUIRE(! (snapshots.front() == l));
+
+    // A snapshot outlives the list it came from
+    auto list = std::make_unique<PersistentSortedList<unsigned, std::string>>();
+    list->insert(1, "One");
+    auto kept = list->snapshot();
+    list.reset();
+    REQUIRE(kept[1] == "One");
+}
+
+TEST_CASE("SnapshotsReadWhileTheListChanges", "[Persistent]")
+{
+    // Readers only ever see their own snapshot, so they need no lock while the writer goes on
+    PersistentSortedList<unsigned, unsigned> l;
+    for (unsigned i = 0; i < 1000; i++)
+    {
+        l.insert(i, i);
+    }
+    std::vector<std::thread> readers;
+    std::vector<unsigned> misses(4, 0);
+    for (unsigned t = 0; t < 4; t++)
+    {
+        readers.emplace_back([snapshot = l.snapshot(), &miss = misses[t]]()
+        {
+            for (unsigned round = 0; round < 5; round++)
+            {
+                unsigned expected = 0;
+                for (const auto & [k, v] : snapshot)
+                {
+                    if (k != expected || v != expected)
+                    {
+                        miss++;
+                    }
+                    expected++;
+                }
+                if (expected != 1000 || snapshot.size() != 1000)
+                {
+                    miss++;
+                }
+            }
+        });
+    }
+    for (unsigned i = 0; i < 1000; i += 2)
+    {
+        l.remove(i);
+        l.insert(i + 1000, i);
+    }
+    for (std::thread & reader : readers)
+    {
+        reader.join();
+    }
+    REQUIRE(misses == std::vector<unsigned>(4, 0));
+    REQUIRE(l.size() == 1000);
+    REQUIRE(l.keyAt(0) == 1);
+}
+
+} // end namespace
@@ -0,0 +1,192 @@
+#include "catch_amalgamated.hpp"
+
+#include <atomic>
+#include <iterator>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ShardedSortedList.hpp"
+
+
+namespace{
+
+TEST_CASE("ShardedBasics", "[Sharded]")
+{
+    ShardedSortedList<unsigned, std::string> l({10, 20});
+    REQUIRE(l.shardCount() == 3);
+    REQUIRE(l.isEmpty());
+    REQUIRE(l.insert(25, "TwentyFive"));
+    REQUIRE(l.insert(1, "One"));
+    REQUIRE(l.try_emplace(10, 3, 'x'));
+    REQUIRE(l.insert(25, "ShouldFail") == false);
+    REQUIRE(l.size() == 3);
+    REQUIRE(l.contains(10));
+    REQUIRE(! l.contains(20));
+    REQUIRE(l[10] == "xxx");
+    REQUIRE(*l.tryGet(1) == "One");
+    REQUIRE_FALSE(l.tryGet(2).has_value());
+    REQUIRE(l.getIndex(1) == 0);
+    REQUIRE(l.getIndex(25) == 2);
+    // the answers are in other shards, past the empty ones between
+    REQUIRE(l.largestLessThan(25) == 10);
+    REQUIRE(l.largestLessThan(10) == 1);
+    REQUIRE(l.smallestGreaterThan(1) == 10);
+    REQUIRE(l.smallestGreaterThan(10) == 25);
+    REQUIRE_THROWS_AS( l[600], KeyNotFoundException );
+    REQUIRE_THROWS_AS( l.getIndex(2), KeyNotFoundException );
+    REQUIRE_THROWS_AS( l.largestLessThan(1), KeyNotFoundException );
+    REQUIRE_THROWS_AS( l.smallestGreaterThan(25), KeyNotFoundException );
+    l.remove(10);
+    l.remove(15);
+    REQUIRE(! l.contains(10));
+    REQUIRE(l.removeRange(0, 100) == 2);
+    REQUIRE(l.isEmpty());
+    // the shards given by splitKeys stay, even empty
+    REQUIRE(l.shardCount() == 3);
+    REQUIRE_THROWS_AS( (ShardedSortedList<unsigned, unsigned>({20, 10})), std::invalid_argument );
+}
+
+TEST_CASE("ShardsSplitAsTheyGrow", "[Sharded]")
+{
+    ShardedSortedList<unsigned, unsigned> l(16);
+    std::map<unsigned, unsigned> expected;
+    for (unsigned i = 0; i < 2000; i++)
+    {
+        unsigned k = (i * 7919) % 4001;
+        REQUIRE(l.insert(k, i) == expected.emplace(k, i).second);
+    }
+    REQUIRE(l.size() == expected.size());
+    REQUIRE(l.shardCount() >= 2000 / 16);
+    unsigned index = 0;
+    for (const auto & [k, v] : expected)
+    {
+        REQUIRE(l.getIndex(k) == index++);
+        REQUIRE(l[k] == v);
+    }
+    auto it = expected.begin();
+    l.forEach([&](unsigned k, unsigned v)
+    {
+        REQUIRE(it != expected.end());
+        REQUIRE(k == it->first);
+        REQUIRE(v == it->second);
+        ++it;
+    });
+    REQUIRE(it == expected.end());
+    // a range across many shards, and lookups across the shards it leaves empty
+    REQUIRE(l.removeRange(1000, 3000) == static_cast<size_t>(std::distance(expected.lower_bound(1000), expected.lower_bound(3000))));
+    expected.erase(expected.lower_bound(1000), expected.lower_bound(3000));
+    REQUIRE(l.size() == expected.size());
+    REQUIRE(l.largestLessThan(3000) == std::prev(expected.lower_bound(1000))->first);
+    REQUIRE(l.smallestGreaterThan(999) == expected.lower_bound(3000)->first);
+}
+
+TEST_CASE("ShardsMergeAsTheyShrink", "[Sharded]")
+{
+    ShardedSortedList<unsigned, unsigned> l(16);
+    for (unsigned i = 0; i < 2000; i++)
+    {
+        l.insert(i, i);
+    }
+    size_t grown = l.shardCount();
+    REQUIRE(grown >= 2000 / 16);
+    // removing most keys one at a time leaves few shards, each still holding the right keys
+    for (unsigned i = 0; i < 2000; i++)
+    {
+        if (i % 50 != 0)
+        {
+            l.remove(i);
+        }
+    }
+    REQUIRE(l.size() == 40);
+    REQUIRE(l.shardCount() <= 40 / 4);
+    for (unsigned i = 0; i < 2000; i += 50)
+    {
+        REQUIRE(l[i] == i);
+        REQUIRE(l.getIndex(i) == i / 50);
+    }
+    REQUIRE(l.largestLessThan(1000) == 950);
+    REQUIRE(l.smallestGreaterThan(1000) == 1050);
+    // and inserting again splits them again
+    for (unsigned i = 0; i < 2000; i++)
+    {
+        l.insert(i, i);
+    }
+    REQUIRE(l.size() == 2000);
+    REQUIRE(l.shardCount() >= 2000 / 16);
+    // a range that empties many shards merges them all away
+    REQUIRE(l.removeRange(0, 2000) == 2000);
+    REQUIRE(l.shardCount() == 1);
+    REQUIRE(l.insert(5, 5));
+    REQUIRE(l[5] == 5);
+
+    // shards split off from given ones merge back, but never across a given bound
+    ShardedSortedList<unsigned, unsigned> given({1000}, 16);
+    for (unsigned i = 0; i < 2000; i++)
+    {
+        given.insert(i, i);
+    }
+    REQUIRE(given.shardCount() >= 2000 / 16);
+    for (unsigned i = 0; i < 2000; i++)
+    {
+        given.remove(i);
+    }
+    REQUIRE(given.isEmpty());
+    REQUIRE(given.shardCount() == 2);
+}
+
+TEST_CASE("ShardedWritersOnTheirOwnRanges", "[Sharded]")
+{
+    // as in ConcurrentReadersAndWriters, with shards small enough that they split while threads run
+    ShardedSortedList<unsigned, unsigned> l(64);
+    for (unsigned i = 0; i < 1000; i++)
+    {
+        l.insert(i * 2, i);
+    }
+    std::atomic<unsigned> misses = 0;
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < 4; t++)
+    {
+        threads.emplace_back([&l, t]()
+        {
+            for (unsigned round = 0; round < 3; round++)
+            {
+                for (unsigned i = t * 250; i < (t + 1) * 250; i++)
+                {
+                    l.insert(i * 2 + 1, round);
+                }
+                for (unsigned i = t * 250; i < (t + 1) * 250; i += 2)
+                {
+                    l.remove(i * 2 + 1);
+                }
+            }
+        });
+        threads.emplace_back([&l, &misses]()
+        {
+            for (unsigned round = 0; round < 5; round++)
+            {
+                for (unsigned i = 0; i < 1000; i++)
+                {
+                    if (! l.contains(i * 2) || l[i * 2] != i)
+                    {
+                        misses++;
+                    }
+                }
+            }
+        });
+    }
+    for (std::thread & thread : threads)
+    {
+        thread.join();
+    }
+    REQUIRE(misses == 0);
+    REQUIRE(l.size() == 1500);
+    for (unsigned i = 0; i < 1000; i++)
+    {
+        REQUIRE(l.contains(i * 2 + 1) == (i % 2 == 1));
+    }
+    REQUIRE(l.getIndex(1998) == 1498);
+}
+
+} // end namespace
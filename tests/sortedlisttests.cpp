@@ -1,11 +1,68 @@
 #include "catch_amalgamated.hpp"
 
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
 #include "SortedList.hpp"
 
 
 namespace{
 
+// an allocator that counts how many times memory is taken from it
+template<typename T>
+struct CountingAllocator
+{
+    using value_type = T;
+
+    unsigned * allocations;
+
+    explicit CountingAllocator(unsigned * a) : allocations(a) {}
+    template<typename U>
+    CountingAllocator(const CountingAllocator<U> & other) : allocations(other.allocations) {}
+
+    T * allocate(size_t n)
+    {
+        (*allocations)++;
+        return std::allocator<T>().allocate(n);
+    }
+    void deallocate(T * p, size_t n)
+    {
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    template<typename U>
+    bool operator==(const CountingAllocator<U> & other) const { return allocations == other.allocations; }
+};
+
+// a value that counts how many times values have been made, copied and moved
+struct Tracked
+{
+    static inline unsigned made = 0;
+    static inline unsigned copies = 0;
+    static inline unsigned moves = 0;
+
+    int n;
+
+    explicit Tracked(int i = 0) : n(i) { made++; }
+    Tracked(int a, int b) : n(a + b) { made++; }
+    Tracked(const Tracked & other) : n(other.n) { copies++; }
+    Tracked(Tracked && other) noexcept : n(other.n) { moves++; }
+    Tracked & operator=(const Tracked &) = default;
+
+    static void reset() { made = copies = moves = 0; }
+};
+
+// whether a list's keys can be looked up by a std::string_view
+template<typename List>
+concept LooksUpByStringView = requires (const List & l, std::string_view v) { l.contains(v); };
+
 TEST_CASE("SizeTest", "[RequiredOne]")
 {
     SortedList<unsigned, std::string> l;
@@ -328,6 +385,989 @@ TEST_CASE("Testing++Operator", "[Explanatory]")
 }
 
 
+TEST_CASE("SizeTracksHeavyChurn", "[Operations]")
+{
+    SortedList<unsigned, unsigned> l;
+    // insert every key twice (the second insert is a duplicate and must not count)
+    for (unsigned i = 0; i < 1000; i++)
+    {
+        l.insert((i * 7919) % 1000, i);
+        l.insert((i * 7919) % 1000, i);
+    }
+    REQUIRE(l.size() == 1000);
+    // remove the even keys, plus a few keys that aren't there
+    for (unsigned i = 0; i < 1000; i += 2)
+    {
+        l.remove(i);
+        l.remove(i + 5000);
+    }
+    REQUIRE(l.size() == 500);
+
+    SortedList<unsigned, unsigned> copy(l);
+    REQUIRE(copy.size() == 500);
+    copy.insert(0, 0);
+    REQUIRE(copy.size() == 501);
+    REQUIRE(l.size() == 500);
+
+    l = copy;
+    REQUIRE(l.size() == 501);
+    for (unsigned i = 0; i < 1000; i++)
+    {
+        l.remove(i);
+    }
+    REQUIRE(l.size() == 0);
+    REQUIRE(l.isEmpty());
+}
+
+TEST_CASE("FrontAndBack", "[Operations]")
+{
+    SortedList<unsigned, std::string> l;
+    REQUIRE_THROWS_AS( l.front(), KeyNotFoundException );
+    REQUIRE_THROWS_AS( l.back(), KeyNotFoundException );
+    l.insert(2, "Two");
+    REQUIRE(l.front() == 2);
+    REQUIRE(l.back() == 2);
+    l.insert(3, "Three");
+    l.insert(1, "One");
+    REQUIRE(l.front() == 1);
+    REQUIRE(l.back() == 3);
+    l.remove(3);
+    REQUIRE(l.back() == 2);
+    l.insert(4, "Four");
+    REQUIRE(l.back() == 4);
+    REQUIRE(l.getIndex(4) == 2);
+}
+
+TEST_CASE("PopFrontAndPopBack", "[Operations]")
+{
+    SortedList<unsigned, std::string> l;
+    l.popFront();
+    l.popBack();
+    l.insert(1, "One");
+    l.insert(2, "Two");
+    l.insert(3, "Three");
+    l.popFront();
+    REQUIRE(! l.contains(1));
+    REQUIRE(l.front() == 2);
+    l.popBack();
+    REQUIRE(! l.contains(3));
+    REQUIRE(l.back() == 2);
+    REQUIRE(l.size() == 1);
+    l.popBack();
+    REQUIRE(l.isEmpty());
+    REQUIRE_THROWS_AS( l.back(), KeyNotFoundException );
+    l.insert(5, "Five");
+    REQUIRE(l.front() == 5);
+    REQUIRE(l.back() == 5);
+}
+
+TEST_CASE("AscendingInserts", "[Operations]")
+{
+    SortedList<unsigned, unsigned> l;
+    for (unsigned i = 0; i < 100; i++)
+    {
+        REQUIRE(l.insert(i, i * 10));
+    }
+    REQUIRE(l.insert(99, 0) == false);
+    REQUIRE(l.size() == 100);
+    REQUIRE(l.back() == 99);
+    REQUIRE(l.getIndex(99) == 99);
+    REQUIRE(l[50] == 500);
+}
+
+TEST_CASE("MatchesStdMapUnderRandomOperations", "[Operations]")
+{
+    SortedList<unsigned, unsigned> l;
+    std::map<unsigned, unsigned> m;
+    unsigned seed = 12345;
+    for (unsigned i = 0; i < 20000; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        unsigned k = (seed >> 8) % 2000;
+        if ((seed >> 4) % 3 == 0)
+        {
+            l.remove(k);
+            m.erase(k);
+        }
+        else
+        {
+            REQUIRE(l.insert(k, i) == m.emplace(k, i).second);
+        }
+    }
+    REQUIRE(l.size() == m.size());
+    unsigned position = 0;
+    for (const auto & [k, v] : m)
+    {
+        REQUIRE(l.contains(k));
+        REQUIRE(l[k] == v);
+        REQUIRE(l.getIndex(k) == position);
+        REQUIRE(l.keyAt(position) == k);
+        REQUIRE(l.atIndex(position) == v);
+        position++;
+    }
+    for (unsigned k = 0; k <= 2000; k++)
+    {
+        auto below = m.lower_bound(k);
+        if (below == m.begin())
+        {
+            REQUIRE_THROWS_AS( l.largestLessThan(k), KeyNotFoundException );
+        }
+        else
+        {
+            REQUIRE(l.largestLessThan(k) == std::prev(below)->first);
+        }
+        auto above = m.upper_bound(k);
+        if (above == m.end())
+        {
+            REQUIRE_THROWS_AS( l.smallestGreaterThan(k), KeyNotFoundException );
+        }
+        else
+        {
+            REQUIRE(l.smallestGreaterThan(k) == above->first);
+        }
+    }
+    SortedList<unsigned, unsigned> copy(l);
+    REQUIRE(copy == l);
+    while (! copy.isEmpty())
+    {
+        REQUIRE(copy.front() == m.begin()->first);
+        REQUIRE(copy.back() == m.rbegin()->first);
+        REQUIRE(copy.getIndex(copy.back()) == copy.size() - 1);
+        REQUIRE(copy.keyAt(copy.size() / 2) == std::next(m.begin(), m.size() / 2)->first);
+        copy.popFront();
+        m.erase(m.begin());
+        if (! m.empty())
+        {
+            copy.popBack();
+            m.erase(std::prev(m.end()));
+        }
+    }
+    REQUIRE(copy.size() == 0);
+}
+
+TEST_CASE("KeyAtAndAtIndex", "[Operations]")
+{
+    SortedList<unsigned, std::string> cms;
+    cms.insert(1729, "Third");
+    cms.insert(561, "First");
+    cms.insert(2465, "Fourth");
+    cms.insert(1105, "Second");
+    REQUIRE(cms.keyAt(0) == 561);
+    REQUIRE(cms.keyAt(3) == 2465);
+    REQUIRE(cms.atIndex(1) == "Second");
+    cms.atIndex(2) = "Changed";
+    REQUIRE(cms[1729] == "Changed");
+    const SortedList<unsigned, std::string> & constCMS = cms;
+    REQUIRE(constCMS.atIndex(0) == "First");
+    REQUIRE_THROWS_AS( cms.keyAt(4), std::out_of_range );
+    REQUIRE_THROWS_AS( constCMS.atIndex(100), std::out_of_range );
+    cms.remove(561);
+    REQUIRE(cms.keyAt(0) == 1105);
+    REQUIRE(cms.getIndex(2465) == 2);
+}
+
+TEST_CASE("NodesComeFromSlabs", "[Memory]")
+{
+    unsigned allocations = 0;
+    using List = SortedList<unsigned, unsigned, std::less<unsigned>, CountingAllocator<std::pair<const unsigned, unsigned>>>;
+    List l{CountingAllocator<std::pair<const unsigned, unsigned>>(&allocations)};
+    for (unsigned i = 0; i < 1000; i++)
+    {
+        l.insert((i * 7919) % 1000, i);
+    }
+    // slabs for the Nodes, plus one allocation per tower (about a quarter of the Nodes)
+    unsigned afterInserts = allocations;
+    REQUIRE(afterInserts < 500);
+    REQUIRE(l.size() == 1000);
+    REQUIRE(l.get_allocator().allocations == &allocations);
+
+    // removed Nodes go on the pool's free list and are reused by the next inserts
+    for (unsigned i = 0; i < 1000; i++)
+    {
+        l.remove(i);
+        l.insert(i + 1000, i);
+    }
+    REQUIRE(l.size() == 1000);
+    REQUIRE(l.getIndex(1500) == 500);
+
+    List copy(l);
+    REQUIRE(copy == l);
+    REQUIRE(copy.get_allocator().allocations == &allocations);
+}
+
+TEST_CASE("DuplicateInsertsDoNotAllocate", "[Memory]")
+{
+    unsigned allocations = 0;
+    SortedList<unsigned, unsigned, std::less<unsigned>, CountingAllocator<std::pair<const unsigned, unsigned>>> l{
+        CountingAllocator<std::pair<const unsigned, unsigned>>(&allocations)};
+    for (unsigned i = 0; i < 1000; i++)
+    {
+        l.insert(i, i);
+    }
+    unsigned afterInserts = allocations;
+    for (unsigned i = 0; i < 1000; i++)
+    {
+        REQUIRE(l.insert(i, 0) == false);
+    }
+    REQUIRE(allocations == afterInserts);
+    REQUIRE(l[500] == 500);
+}
+
+TEST_CASE("CopiesShareNodesUntilChanged", "[CopyOnWrite]")
+{
+    unsigned allocations = 0;
+    using List = SortedList<unsigned, unsigned, std::less<unsigned>, CountingAllocator<std::pair<const unsigned, unsigned>>>;
+    List l{CountingAllocator<std::pair<const unsigned, unsigned>>(&allocations)};
+    for (unsigned i = 0; i < 1000; i++)
+    {
+        l.insert(i, i);
+    }
+    unsigned afterInserts = allocations;
+
+    // copies, and const lookups in them, take no memory
+    List copy(l);
+    List another = copy;
+    REQUIRE(allocations == afterInserts);
+    REQUIRE(copy == l);
+    REQUIRE(std::as_const(copy)[500] == 500);
+    REQUIRE(another.getIndex(999) == 999);
+    REQUIRE(allocations == afterInserts);
+
+    // the first change gives a list Nodes of its own, and the others don't see it
+    copy.insert(1000, 1000);
+    copy.remove(0);
+    REQUIRE(allocations > afterInserts);
+    REQUIRE(copy.size() == 1000);
+    REQUIRE(! l.contains(1000));
+    REQUIRE(another.contains(0));
+    // so does handing out a value that can be changed
+    another[5] = 50;
+    REQUIRE(l[5] == 5);
+    REQUIRE(another[5] == 50);
+
+    // once nothing else shares them, a list changes its Nodes in place
+    unsigned beforeChanges = allocations;
+    l[1] = 10;
+    l.remove(2);
+    REQUIRE(allocations == beforeChanges);
+    REQUIRE(std::as_const(copy)[1] == 1);
+    REQUIRE(copy.contains(2));
+
+    // a hint taken while the Nodes were shared still works once they are copied
+    List shared{CountingAllocator<std::pair<const unsigned, unsigned>>(&allocations)};
+    shared.insert(1, 1);
+    List hinted(shared);
+    auto hint = hinted.cend();
+    REQUIRE(hinted.insert(hint, 1001, 1)->key == 1001);
+    REQUIRE(hinted.size() == 2);
+    REQUIRE(! shared.contains(1001));
+}
+
+TEST_CASE("ChangesThroughReferencesDontReachCopies", "[CopyOnWrite]")
+{
+    // a reference taken before the copy
+    SortedList<unsigned, unsigned> a;
+    a.insert(1, 10);
+    a.insert(2, 20);
+    unsigned & r = a[1];
+    SortedList<unsigned, unsigned> b(a);
+    r = 999;
+    REQUIRE(a[1] == 999);
+    REQUIRE(std::as_const(b)[1] == 10);
+
+    // an iterator taken before the copy, including one that moves back from the end
+    auto it = a.begin();
+    auto last = a.end();
+    SortedList<unsigned, unsigned> c(a);
+    it->value = 77;
+    (--last)->value = 88;
+    REQUIRE(std::as_const(a)[1] == 77);
+    REQUIRE(std::as_const(a)[2] == 88);
+    REQUIRE(std::as_const(c)[1] == 999);
+    REQUIRE(std::as_const(c)[2] == 20);
+
+    // the same through assignment, and into a copy of a copy
+    SortedList<unsigned, unsigned> d;
+    d = a;
+    SortedList<unsigned, unsigned> e(d);
+    r = 5;
+    REQUIRE(std::as_const(d)[1] == 77);
+    REQUIRE(std::as_const(e)[1] == 77);
+}
+
+TEST_CASE("InsertMovesInsteadOfCopying", "[Moves]")
+{
+    SortedList<std::string, Tracked> l;
+    Tracked::reset();
+    std::string key = "a key that is long enough not to fit in the small string buffer";
+    REQUIRE(l.insert(std::move(key), Tracked(1)));
+    REQUIRE(Tracked::copies == 0);
+    REQUIRE(Tracked::moves == 1);
+    REQUIRE(l["a key that is long enough not to fit in the small string buffer"].n == 1);
+    REQUIRE(l.insert("a key that is long enough not to fit in the small string buffer", Tracked(2)) == false);
+    REQUIRE(Tracked::copies == 0);
+}
+
+TEST_CASE("EmplaceBuildsInPlace", "[Moves]")
+{
+    SortedList<std::string, Tracked> l;
+    Tracked::reset();
+    REQUIRE(l.emplace(std::piecewise_construct, std::forward_as_tuple("one"), std::forward_as_tuple(1, 2)));
+    REQUIRE(Tracked::made == 1);
+    REQUIRE(Tracked::copies + Tracked::moves == 0);
+    REQUIRE(l["one"].n == 3);
+    REQUIRE(l.emplace("two", 2));
+    REQUIRE(l["two"].n == 2);
+    // a duplicate key still makes the pair (like std::map), but doesn't keep it
+    REQUIRE(l.emplace("one", 5) == false);
+    REQUIRE(l["one"].n == 3);
+    REQUIRE(l.size() == 2);
+}
+
+TEST_CASE("TryEmplaceSkipsDuplicates", "[Moves]")
+{
+    SortedList<std::string, Tracked> l;
+    Tracked::reset();
+    REQUIRE(l.try_emplace("one", 1, 2));
+    REQUIRE(Tracked::made == 1);
+    REQUIRE(Tracked::copies + Tracked::moves == 0);
+    // the value is never made for a key that is already there
+    REQUIRE(l.try_emplace("one", 7) == false);
+    REQUIRE(Tracked::made == 1);
+    std::string key = "two";
+    REQUIRE(l.try_emplace(std::move(key), 4));
+    REQUIRE(l["one"].n == 3);
+    REQUIRE(l["two"].n == 4);
+    REQUIRE(l.getIndex("two") == 1);
+}
+
+TEST_CASE("MoveConstructionStealsNodes", "[Moves]")
+{
+    static_assert(std::is_nothrow_move_constructible_v<SortedList<unsigned, std::string>>);
+    static_assert(std::is_nothrow_move_assignable_v<SortedList<unsigned, std::string>>);
+
+    SortedList<unsigned, Tracked> l;
+    for (int i = 0; i < 100; i++)
+    {
+        l.try_emplace(i, i);
+    }
+    Tracked::reset();
+    SortedList<unsigned, Tracked> moved(std::move(l));
+    REQUIRE(Tracked::copies + Tracked::moves == 0);
+    REQUIRE(moved.size() == 100);
+    REQUIRE(moved.getIndex(42) == 42);
+    REQUIRE(moved[99].n == 99);
+    // the moved-from list is empty, and still usable
+    REQUIRE(l.isEmpty());
+    REQUIRE(! l.contains(1));
+    l.try_emplace(5, 5);
+    REQUIRE(l.size() == 1);
+    REQUIRE(l[5].n == 5);
+}
+
+TEST_CASE("MoveAssignmentAndSwap", "[Moves]")
+{
+    SortedList<unsigned, std::string> l;
+    l.insert(1, "One");
+    l.insert(2, "Two");
+    SortedList<unsigned, std::string> p;
+    p.insert(3, "Three");
+
+    p = std::move(l);
+    REQUIRE(p.size() == 2);
+    REQUIRE(p[2] == "Two");
+    REQUIRE(! p.contains(3));
+    REQUIRE(l.isEmpty());
+
+    SortedList<unsigned, std::string> q;
+    q.insert(4, "Four");
+    swap(p, q);
+    REQUIRE(p.size() == 1);
+    REQUIRE(p[4] == "Four");
+    REQUIRE(q.size() == 2);
+    REQUIRE(q.getIndex(2) == 1);
+    q.insert(0, "Zero");
+    REQUIRE(q.front() == 0);
+}
+
+TEST_CASE("VectorOfListsMovesOnGrowth", "[Moves]")
+{
+    std::vector<SortedList<unsigned, Tracked>> lists;
+    for (int i = 0; i < 50; i++)
+    {
+        SortedList<unsigned, Tracked> l;
+        l.try_emplace(i, i);
+        l.try_emplace(i + 1, i + 1);
+        Tracked::reset();
+        lists.push_back(std::move(l));
+        // growing the vector moves the lists, so no values are ever copied or moved
+        REQUIRE(Tracked::copies + Tracked::moves == 0);
+    }
+    REQUIRE(lists[10][11].n == 11);
+    REQUIRE(lists[49].size() == 2);
+}
+
+TEST_CASE("RangeForVisitsKeysInOrder", "[Iterators]")
+{
+    static_assert(std::bidirectional_iterator<SortedList<unsigned, std::string>::iterator>);
+    static_assert(std::bidirectional_iterator<SortedList<unsigned, std::string>::const_iterator>);
+    SortedList<unsigned, unsigned> p;
+    std::map<unsigned, unsigned> m;
+    for (unsigned i = 0; i < 500; i++)
+    {
+        unsigned k = (i * 7919) % 1000;
+        p.insert(k, i);
+        m[k] = i;
+    }
+    std::vector<unsigned> keys;
+    for (const auto & [key, value] : p)
+    {
+        REQUIRE(m.at(key) == value);
+        keys.push_back(key);
+    }
+    REQUIRE(keys.size() == m.size());
+    REQUIRE(std::is_sorted(keys.begin(), keys.end()));
+    REQUIRE(std::distance(p.cbegin(), p.cend()) == 500);
+}
+
+TEST_CASE("ReverseIteration", "[Iterators]")
+{
+    SortedList<unsigned, std::string> p;
+    REQUIRE(p.begin() == p.end());
+    REQUIRE(p.rbegin() == p.rend());
+    p.insert(2, "Two");
+    p.insert(1, "One");
+    p.insert(3, "Three");
+    std::vector<unsigned> keys;
+    for (auto it = p.rbegin(); it != p.rend(); ++it)
+    {
+        keys.push_back(it->key);
+    }
+    REQUIRE(keys == std::vector<unsigned>{3, 2, 1});
+    // stepping back from end() lands on the largest key
+    auto last = p.end();
+    --last;
+    REQUIRE(last->value == "Three");
+    REQUIRE(std::prev(last)->key == 2);
+}
+
+TEST_CASE("ValuesChangeThroughIterators", "[Iterators]")
+{
+    SortedList<unsigned, unsigned> p;
+    for (unsigned i = 0; i < 10; i++)
+    {
+        p.insert(i, i);
+    }
+    for (auto & entry : p)
+    {
+        entry.value *= 2;
+    }
+    auto found = std::find_if(p.begin(), p.end(), [](const auto & e) { return e.value == 14; });
+    REQUIRE(found != p.end());
+    REQUIRE(found->key == 7);
+    const SortedList<unsigned, unsigned> & c = p;
+    SortedList<unsigned, unsigned>::const_iterator ci = p.begin();
+    REQUIRE(ci == c.begin());
+    REQUIRE(c[9] == 18);
+    static_assert(std::is_same_v<decltype(*c.begin()), const SortedList<unsigned, unsigned>::Entry &>);
+}
+
+TEST_CASE("HintedInsertReturnsTheKey", "[Bulk]")
+{
+    SortedList<unsigned, std::string> p;
+    auto it = p.insert(p.end(), 5, "Five");
+    REQUIRE(it->key == 5);
+    // each key goes right before the last one, so the hint is always exact
+    for (unsigned k = 4; k > 0; k--)
+    {
+        it = p.insert(it, k, "Smaller");
+        REQUIRE(it->key == k);
+        REQUIRE(it == p.begin());
+    }
+    // a duplicate is not inserted, and the iterator points at the key that was already there
+    auto same = p.insert(p.end(), 3, "Again");
+    REQUIRE(same->key == 3);
+    REQUIRE(same->value == "Smaller");
+    REQUIRE(p.size() == 5);
+    auto made = p.emplace_hint(p.begin(), 6u, "Six");
+    REQUIRE(made->key == 6);
+    REQUIRE(std::next(made) == p.end());
+    REQUIRE(p.emplace_hint(made, 6u, "Dup") == made);
+    REQUIRE(p.getIndex(6) == 5);
+}
+
+TEST_CASE("HintedInsertMatchesStdMap", "[Bulk]")
+{
+    SortedList<unsigned, unsigned> p;
+    std::map<unsigned, unsigned> m;
+    auto hint = p.end();
+    unsigned k = 5000;
+    for (unsigned i = 0; i < 4000; i++)
+    {
+        // mostly keys close to the last one, with the occasional jump far away
+        k = i % 97 == 0 ? (k * 7919 + 13) % 10000 : k + (i % 3) - 1;
+        hint = p.insert(i % 5 == 0 ? p.begin() : hint, k, i);
+        m.emplace(k, i);
+        REQUIRE(hint->key == k);
+    }
+    REQUIRE(p.size() == m.size());
+    unsigned index = 0;
+    auto it = p.begin();
+    for (const auto & [key, value] : m)
+    {
+        REQUIRE(it->key == key);
+        REQUIRE(it->value == value);
+        REQUIRE(p.getIndex(key) == index);
+        REQUIRE(p.keyAt(index) == key);
+        ++it;
+        index++;
+    }
+}
+
+TEST_CASE("BuildFromSortedRange", "[Bulk]")
+{
+    std::vector<std::pair<unsigned, std::string>> pairs;
+    for (unsigned i = 0; i < 3000; i++)
+    {
+        pairs.emplace_back(i * 2, std::to_string(i));
+    }
+    SortedList<unsigned, std::string> p(pairs.begin(), pairs.end());
+    REQUIRE(p.size() == 3000);
+    for (unsigned i = 0; i < 3000; i += 7)
+    {
+        REQUIRE(p[i * 2] == std::to_string(i));
+        REQUIRE(p.getIndex(i * 2) == i);
+        REQUIRE(p.keyAt(i) == i * 2);
+    }
+    REQUIRE_FALSE(p.contains(1));
+    // the list still works as usual afterwards
+    REQUIRE(p.insert(1, "Odd"));
+    REQUIRE(p.getIndex(2) == 2);
+    // a list can be made from another container's entries, including another list's
+    std::map<unsigned, std::string> m(pairs.begin(), pairs.end());
+    SortedList<unsigned, std::string> fromMap(m.begin(), m.end());
+    SortedList<unsigned, std::string> fromList(fromMap.begin(), fromMap.end());
+    REQUIRE(fromList == fromMap);
+    REQUIRE(fromList.size() == 3000);
+}
+
+TEST_CASE("BuildFromUnsortedRange", "[Bulk]")
+{
+    std::vector<std::pair<unsigned, unsigned>> pairs;
+    std::map<unsigned, unsigned> m;
+    for (unsigned i = 0; i < 2000; i++)
+    {
+        // mostly increasing, with some keys out of order and some repeated
+        unsigned k = i % 10 == 0 ? (i * 7919) % 2000 : i;
+        pairs.emplace_back(k, i);
+        m.emplace(k, i);
+    }
+    SortedList<unsigned, unsigned> p(pairs.begin(), pairs.end());
+    REQUIRE(p.size() == m.size());
+    unsigned index = 0;
+    for (const auto & [key, value] : m)
+    {
+        REQUIRE(p[key] == value);
+        REQUIRE(p.getIndex(key) == index);
+        index++;
+    }
+}
+
+TEST_CASE("AssignSortedChecksOrder", "[Bulk]")
+{
+    SortedList<unsigned, std::string> p;
+    p.insert(100, "Hundred");
+    std::vector<std::pair<unsigned, std::string>> good = {{1, "One"}, {2, "Two"}, {5, "Five"}};
+    p.assignSorted(good.begin(), good.end());
+    REQUIRE(p.size() == 3);
+    REQUIRE_FALSE(p.contains(100));
+    REQUIRE(p.back() == 5);
+    REQUIRE(p.getIndex(5) == 2);
+    std::vector<std::pair<unsigned, std::string>> unsorted = {{1, "One"}, {3, "Three"}, {2, "Two"}};
+    REQUIRE_THROWS_AS(p.assignSorted(unsorted.begin(), unsorted.end()), std::invalid_argument);
+    std::vector<std::pair<unsigned, std::string>> duplicated = {{1, "One"}, {1, "Uno"}};
+    REQUIRE_THROWS_AS(p.assignSorted(duplicated.begin(), duplicated.end()), std::invalid_argument);
+    // a failed assignSorted leaves the list alone
+    REQUIRE(p.size() == 3);
+    REQUIRE(p[2] == "Two");
+    p.assignSorted(unsorted.end(), unsorted.end());
+    REQUIRE(p.isEmpty());
+}
+
+TEST_CASE("InsertBatchReportsEachKey", "[Bulk]")
+{
+    SortedList<unsigned, std::string> p;
+    p.insert(2, "Two");
+    p.insert(4, "Four");
+    std::vector<std::pair<unsigned, std::string>> batch = {{5, "Five"}, {2, "Deux"}, {1, "One"}, {5, "Cinq"}, {3, "Three"}};
+    std::vector<bool> inserted = p.insertBatch(batch);
+    REQUIRE(inserted == std::vector<bool>{true, false, true, false, true});
+    REQUIRE(p.size() == 5);
+    // the first of two repeated keys in a batch wins, and keys already present are left alone
+    REQUIRE(p[5] == "Five");
+    REQUIRE(p[2] == "Two");
+    REQUIRE(p.getIndex(3) == 2);
+    REQUIRE(p.insertBatch(std::vector<std::pair<unsigned, std::string>>{}).empty());
+}
+
+TEST_CASE("InsertBatchMatchesStdMap", "[Bulk]")
+{
+    SortedList<unsigned, unsigned> p;
+    std::map<unsigned, unsigned> m;
+    for (unsigned round = 0; round < 20; round++)
+    {
+        std::vector<std::pair<unsigned, unsigned>> batch;
+        for (unsigned i = 0; i < 300; i++)
+        {
+            batch.emplace_back((round * 7919 + i * 104729) % 5000, round);
+        }
+        std::vector<bool> inserted = p.insertBatch(batch);
+        for (size_t i = 0; i < batch.size(); i++)
+        {
+            REQUIRE(inserted[i] == m.insert(batch[i]).second);
+        }
+        REQUIRE(p.size() == m.size());
+    }
+    unsigned index = 0;
+    for (const auto & [key, value] : m)
+    {
+        REQUIRE(p[key] == value);
+        REQUIRE(p.keyAt(index) == key);
+        index++;
+    }
+}
+
+TEST_CASE("RemoveRangeCutsOutARun", "[Bulk]")
+{
+    SortedList<unsigned, unsigned> p;
+    std::map<unsigned, unsigned> m;
+    for (unsigned i = 0; i < 3000; i++)
+    {
+        p.insert(i * 3, i);
+        m[i * 3] = i;
+    }
+    REQUIRE(p.removeRange(10, 10) == 0);
+    REQUIRE(p.removeRange(20, 10) == 0);
+    REQUIRE(p.removeRange(1, 3) == 0);
+    for (unsigned round = 0; round < 30; round++)
+    {
+        unsigned lo = (round * 7919) % 9000;
+        unsigned hi = lo + (round * 104729) % 700;
+        size_t expected = std::distance(m.lower_bound(lo), m.lower_bound(hi));
+        m.erase(m.lower_bound(lo), m.lower_bound(hi));
+        REQUIRE(p.removeRange(lo, hi) == expected);
+        REQUIRE(p.size() == m.size());
+    }
+    unsigned index = 0;
+    for (const auto & [key, value] : m)
+    {
+        REQUIRE(p.keyAt(index) == key);
+        REQUIRE(p.getIndex(key) == index);
+        index++;
+    }
+    // removing everything leaves an empty list that still works
+    REQUIRE(p.removeRange(0, 10000) == m.size());
+    REQUIRE(p.isEmpty());
+    REQUIRE(p.begin() == p.end());
+    p.insert(5, 5);
+    REQUIRE(p.back() == 5);
+}
+
+TEST_CASE("RemoveIfRemovesMatches", "[Bulk]")
+{
+    SortedList<unsigned, unsigned> p;
+    for (unsigned i = 0; i < 2000; i++)
+    {
+        p.insert(i, i % 7);
+    }
+    REQUIRE(p.removeIf([](const auto & e) { return e.value == 3; }) == 286);
+    REQUIRE(p.size() == 1714);
+    REQUIRE_FALSE(p.contains(3));
+    REQUIRE(p.contains(4));
+    REQUIRE(p.getIndex(4) == 3);
+    REQUIRE(p.keyAt(1713) == 1999);
+    REQUIRE(p.back() == 1999);
+    // a predicate that throws partway leaves the list whole, without what it had already removed
+    unsigned calls = 0;
+    REQUIRE_THROWS(p.removeIf([&calls](const auto & e)
+    {
+        if (++calls == 1000)
+        {
+            throw std::runtime_error{"stop"};
+        }
+        return e.key % 2 == 0;
+    }));
+    REQUIRE(p.size() == 1714 - 500);
+    unsigned index = 0;
+    for (const auto & [key, value] : p)
+    {
+        REQUIRE(p.getIndex(key) == index);
+        index++;
+    }
+    REQUIRE(p.removeIf([](const auto &) { return true; }) == 1214);
+    REQUIRE(p.isEmpty());
+}
+
+TEST_CASE("RemoveBatchRemovesPresentKeys", "[Bulk]")
+{
+    SortedList<unsigned, unsigned> p;
+    std::map<unsigned, unsigned> m;
+    for (unsigned i = 0; i < 3000; i++)
+    {
+        p.insert(i, i);
+        m[i] = i;
+    }
+    std::vector<unsigned> sorted;
+    for (unsigned i = 0; i < 4000; i += 3)
+    {
+        sorted.push_back(i);
+    }
+    REQUIRE(p.removeBatch(sorted) == 1000);
+    // keys out of order, repeated, or missing still work
+    std::vector<unsigned> unsorted = {2999, 5, 5, 1, 3, 2000, 7};
+    REQUIRE(p.removeBatch(unsorted) == 5);
+    for (unsigned k : sorted)
+    {
+        m.erase(k);
+    }
+    for (unsigned k : unsorted)
+    {
+        m.erase(k);
+    }
+    REQUIRE(p.size() == m.size());
+    unsigned index = 0;
+    for (const auto & [key, value] : m)
+    {
+        REQUIRE(p.keyAt(index) == key);
+        REQUIRE(p.getIndex(key) == index);
+        index++;
+    }
+}
+
+TEST_CASE("BoundsMatchStdMap", "[Lookup]")
+{
+    SortedList<unsigned, unsigned> p;
+    std::map<unsigned, unsigned> m;
+    for (unsigned i = 0; i < 2000; i++)
+    {
+        p.insert(i * 5, i);
+        m[i * 5] = i;
+    }
+    for (unsigned k = 0; k < 10010; k += 3)
+    {
+        auto lower = m.lower_bound(k);
+        auto upper = m.upper_bound(k);
+        auto pLower = p.lowerBound(k);
+        auto pUpper = p.upperBound(k);
+        REQUIRE((pLower == p.end()) == (lower == m.end()));
+        REQUIRE((pUpper == p.end()) == (upper == m.end()));
+        if (lower != m.end())
+        {
+            REQUIRE(pLower->key == lower->first);
+            REQUIRE(p.ceiling(k)->key == lower->first);
+        }
+        if (upper != m.end())
+        {
+            REQUIRE(pUpper->key == upper->first);
+        }
+        // the floor is the key before the upper bound
+        if (upper == m.begin())
+        {
+            REQUIRE(p.floor(k) == p.end());
+        }
+        else
+        {
+            REQUIRE(p.floor(k)->key == std::prev(upper)->first);
+        }
+        auto [first, last] = p.equalRange(k);
+        REQUIRE(first == pLower);
+        REQUIRE(last == pUpper);
+    }
+}
+
+TEST_CASE("BoundsReturnEndInsteadOfThrowing", "[Lookup]")
+{
+    SortedList<unsigned, std::string> cms;
+    const SortedList<unsigned, std::string> & constCMS = cms;
+    REQUIRE(cms.lowerBound(5) == cms.end());
+    REQUIRE(constCMS.floor(5) == constCMS.end());
+    cms.insert(561, "First");
+    cms.insert(1105, "Second");
+    cms.insert(1729, "Third");
+    REQUIRE(constCMS.floor(560) == constCMS.end());
+    REQUIRE(constCMS.floor(561)->value == "First");
+    REQUIRE(constCMS.floor(1728)->value == "Second");
+    REQUIRE(constCMS.upperBound(1729) == constCMS.end());
+    REQUIRE(constCMS.ceiling(1729)->value == "Third");
+    // values can be changed through the iterators of a non-const list
+    cms.lowerBound(1000)->value = "Changed";
+    REQUIRE(cms[1105] == "Changed");
+    auto [first, last] = constCMS.equalRange(600);
+    REQUIRE(first == last);
+    REQUIRE(first->key == 1105);
+}
+
+TEST_CASE("RangeVisitsKeysBetween", "[Lookup]")
+{
+    SortedList<unsigned, unsigned> p;
+    std::map<unsigned, unsigned> m;
+    for (unsigned i = 0; i < 3000; i++)
+    {
+        p.insert(i * 3, i);
+        m[i * 3] = i;
+    }
+    for (unsigned round = 0; round < 40; round++)
+    {
+        unsigned lo = (round * 7919) % 9500;
+        unsigned hi = lo + (round * 104729) % 900;
+        std::vector<unsigned> expected;
+        for (auto it = m.lower_bound(lo); it != m.lower_bound(hi); ++it)
+        {
+            expected.push_back(it->first);
+        }
+        std::vector<unsigned> keys;
+        for (const auto & [key, value] : p.range(lo, hi))
+        {
+            keys.push_back(key);
+        }
+        REQUIRE(keys == expected);
+        REQUIRE(p.countRange(lo, hi) == expected.size());
+    }
+    REQUIRE(p.range(20, 10).empty());
+    REQUIRE(p.countRange(20, 10) == 0);
+    REQUIRE(p.countRange(0, 100000) == 3000);
+    // values can be changed through the view of a non-const list
+    for (auto & entry : p.range(3, 7))
+    {
+        entry.value = 100;
+    }
+    REQUIRE(p[6] == 100);
+    const SortedList<unsigned, unsigned> & constP = p;
+    REQUIRE(std::ranges::distance(constP.range(9000, 9100)) == 0);
+    REQUIRE(constP.range(8990, 9100).begin()->key == 8991);
+}
+
+TEST_CASE("LookupsWithoutThrowing", "[Lookup]")
+{
+    SortedList<unsigned, std::string> cms;
+    cms.insert(561, "First");
+    cms.insert(1105, "Second");
+    cms.insert(1729, "Third");
+    REQUIRE(cms.find(1105)->value == "Second");
+    REQUIRE(cms.find(600) == cms.end());
+    REQUIRE(cms.tryGet(600) == nullptr);
+    REQUIRE(*cms.tryGet(1729) == "Third");
+    *cms.tryGet(561) = "Changed";
+    REQUIRE(cms[561] == "Changed");
+    REQUIRE(cms.tryGetIndex(1729) == 2u);
+    REQUIRE_FALSE(cms.tryGetIndex(1730).has_value());
+
+    const SortedList<unsigned, std::string> & constCMS = cms;
+    REQUIRE(constCMS.find(1729) != constCMS.end());
+    REQUIRE(constCMS.find(0) == constCMS.end());
+    REQUIRE(*constCMS.tryGet(1105) == "Second");
+    REQUIRE(constCMS.tryGet(6000) == nullptr);
+}
+
+TEST_CASE("CompareOrdersTheKeys", "[Compare]")
+{
+    SortedList<unsigned, unsigned, std::greater<unsigned>> p;
+    std::map<unsigned, unsigned, std::greater<unsigned>> m;
+    for (unsigned i = 0; i < 2000; i++)
+    {
+        unsigned k = (i * 7919) % 3000;
+        REQUIRE(p.insert(k, i) == m.emplace(k, i).second);
+    }
+    REQUIRE(p.front() == m.begin()->first);
+    REQUIRE(p.back() == m.rbegin()->first);
+    unsigned index = 0;
+    for (const auto & [key, value] : m)
+    {
+        REQUIRE(p.keyAt(index) == key);
+        REQUIRE(p.getIndex(key) == index);
+        REQUIRE(p[key] == value);
+        index++;
+    }
+    // "less than" and "greater than" follow the list's order
+    REQUIRE(p.largestLessThan(1000) == std::prev(m.lower_bound(1000))->first);
+    REQUIRE(p.smallestGreaterThan(1000) == m.upper_bound(1000)->first);
+    REQUIRE(p.countRange(2000, 1000) == static_cast<size_t>(std::distance(m.lower_bound(2000), m.lower_bound(1000))));
+    for (unsigned k = 0; k < 3000; k += 7)
+    {
+        p.remove(k);
+        m.erase(k);
+        REQUIRE_FALSE(p.contains(k));
+    }
+    REQUIRE(p.size() == m.size());
+    REQUIRE(std::equal(p.begin(), p.end(), m.begin(), m.end(), [](const auto & e, const auto & pair)
+    {
+        return e.key == pair.first && e.value == pair.second;
+    }));
+}
+
+TEST_CASE("CompareCanHaveState", "[Compare]")
+{
+    // orders keys by their remainder, so keys with the same remainder are the same key
+    struct ByRemainder
+    {
+        unsigned divisor;
+        bool operator()(unsigned a, unsigned b) const { return a % divisor < b % divisor; }
+    };
+    SortedList<unsigned, std::string, ByRemainder> p{ByRemainder{10}};
+    REQUIRE(p.insert(13, "Thirteen"));
+    REQUIRE(p.insert(21, "Twenty-one"));
+    REQUIRE_FALSE(p.insert(3, "Three"));
+    REQUIRE(p[23] == "Thirteen");
+    REQUIRE(p.front() == 21);
+    REQUIRE(p.size() == 2);
+    REQUIRE(p.key_comp().divisor == 10);
+    SortedList<unsigned, std::string, ByRemainder> copy(p);
+    REQUIRE(copy.contains(33));
+    REQUIRE(copy.key_comp().divisor == 10);
+
+    // assignment takes the order along with the keys
+    SortedList<unsigned, std::string, ByRemainder> assigned{ByRemainder{7}};
+    assigned.insert(6, "Six");
+    assigned = p;
+    REQUIRE(assigned.key_comp().divisor == 10);
+    REQUIRE(assigned.contains(33));
+    REQUIRE_FALSE(assigned.contains(6));
+    REQUIRE(assigned.insert(4, "Four"));
+    REQUIRE_FALSE(assigned.insert(14, "Fourteen"));
+    REQUIRE(assigned.getIndex(13) == 1);
+    REQUIRE(assigned.largestLessThan(3) == 21);
+    REQUIRE(p.size() == 2);
+}
+
+TEST_CASE("TransparentCompareLooksUpOtherTypes", "[Compare]")
+{
+    SortedList<std::string, unsigned, std::less<>> numbers;
+    numbers.insert("Jenny", 8675309);
+    numbers.insert("Ghostbusters", 5552368);
+    const char * name = "Jenny";
+    std::string_view view = "Ghostbusters";
+    REQUIRE(numbers.contains(name));
+    REQUIRE(numbers.contains(view));
+    REQUIRE_FALSE(numbers.contains(std::string_view("Jen")));
+    REQUIRE(numbers[name] == 8675309);
+    numbers[view] = 5550000;
+    REQUIRE(*numbers.tryGet(view) == 5550000);
+    REQUIRE(numbers.tryGet("Nobody") == nullptr);
+    REQUIRE(numbers.find(view)->key == "Ghostbusters");
+    REQUIRE(numbers.find("Nobody") == numbers.end());
+    REQUIRE_THROWS_AS( numbers["Nobody"], KeyNotFoundException );
+
+    const SortedList<std::string, unsigned, std::less<>> & constNumbers = numbers;
+    REQUIRE(constNumbers[view] == 5550000);
+    REQUIRE(constNumbers.find(name) != constNumbers.end());
+    REQUIRE(*constNumbers.tryGet(name) == 8675309);
+
+    // without a transparent Compare, only a std::string can be looked up
+    STATIC_REQUIRE_FALSE(LooksUpByStringView<SortedList<std::string, unsigned>>);
+    STATIC_REQUIRE(LooksUpByStringView<SortedList<std::string, unsigned, std::less<>>>);
+}
+
+
 
 
 
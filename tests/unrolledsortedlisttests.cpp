@@ -0,0 +1,332 @@
+#include "catch_amalgamated.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include "UnrolledSortedList.hpp"
+
+
+namespace{
+
+TEST_CASE("UnrolledBasics", "[Unrolled]")
+{
+    UnrolledSortedList<unsigned, std::string> l;
+    REQUIRE(l.isEmpty());
+    REQUIRE(l.insert(2, "Two"));
+    REQUIRE(l.insert(1, "One"));
+    REQUIRE(l.insert(3, "Three"));
+    REQUIRE(l.insert(2, "ShouldFail") == false);
+    REQUIRE(l.size() == 3);
+    REQUIRE(l.contains(1));
+    REQUIRE(! l.contains(4));
+    REQUIRE(l.getIndex(3) == 2);
+    REQUIRE(l[2] == "Two");
+    REQUIRE(l.front() == 1);
+    REQUIRE(l.back() == 3);
+    REQUIRE_THROWS_AS( l.getIndex(600), KeyNotFoundException );
+    REQUIRE_THROWS_AS( l[600], KeyNotFoundException );
+    l.remove(2);
+    REQUIRE(! l.contains(2));
+    REQUIRE(l.size() == 2);
+
+    const UnrolledSortedList<unsigned, std::string> & constL = l;
+    REQUIRE(constL[3] == "Three");
+}
+
+TEST_CASE("UnrolledLargestLessThanAndSmallestGreaterThan", "[Unrolled]")
+{
+    UnrolledSortedList<unsigned, std::string, 4> cms;
+    cms.insert(561, "First");
+    cms.insert(1105, "Second");
+    cms.insert(1729, "Third");
+    cms.insert(2465, "Fourth");
+    cms.insert(2821, "Fifth");
+    REQUIRE_THROWS_AS( cms.largestLessThan(561), KeyNotFoundException );
+    REQUIRE( cms.largestLessThan(1104) == 561 );
+    REQUIRE( cms.largestLessThan(2465) == 1729 );
+    REQUIRE( cms.largestLessThan(4096) == 2821 );
+    REQUIRE_THROWS_AS( cms.smallestGreaterThan(2821), KeyNotFoundException );
+    REQUIRE( cms.smallestGreaterThan(1) == 561 );
+    REQUIRE( cms.smallestGreaterThan(1729) == 2465 );
+}
+
+TEST_CASE("UnrolledMatchesStdMapUnderRandomOperations", "[Unrolled]")
+{
+    // small Blocks, so splits and merges happen all the time
+    UnrolledSortedList<unsigned, unsigned, 4> l;
+    std::map<unsigned, unsigned> m;
+    unsigned seed = 54321;
+    for (unsigned i = 0; i < 20000; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        unsigned k = (seed >> 8) % 1000;
+        if ((seed >> 4) % 3 == 0)
+        {
+            l.remove(k);
+            m.erase(k);
+        }
+        else
+        {
+            REQUIRE(l.insert(k, i) == m.emplace(k, i).second);
+        }
+    }
+    REQUIRE(l.size() == m.size());
+    REQUIRE(std::equal(l.begin(), l.end(), m.begin(), m.end(), [](auto a, const auto & b)
+    {
+        return a.key == b.first && a.value == b.second;
+    }));
+    unsigned position = 0;
+    for (const auto & [k, v] : m)
+    {
+        REQUIRE(l[k] == v);
+        REQUIRE(l.getIndex(k) == position);
+        position++;
+    }
+    for (unsigned k = 0; k <= 1000; k++)
+    {
+        auto below = m.lower_bound(k);
+        if (below != m.begin())
+        {
+            REQUIRE(l.largestLessThan(k) == std::prev(below)->first);
+        }
+        auto above = m.upper_bound(k);
+        if (above != m.end())
+        {
+            REQUIRE(l.smallestGreaterThan(k) == above->first);
+        }
+    }
+}
+
+TEST_CASE("UnrolledIteration", "[Unrolled]")
+{
+    static_assert(std::bidirectional_iterator<UnrolledSortedList<unsigned, unsigned>::iterator>);
+    static_assert(std::bidirectional_iterator<UnrolledSortedList<unsigned, unsigned>::const_iterator>);
+
+    UnrolledSortedList<unsigned, unsigned, 4> l;
+    for (unsigned i = 20; i > 0; i--)
+    {
+        l.insert(i, i * 10);
+    }
+    unsigned expected = 1;
+    for (auto [k, v] : l)
+    {
+        REQUIRE(k == expected);
+        REQUIRE(v == expected * 10);
+        // values can be changed through a non-const iterator
+        v++;
+        expected++;
+    }
+    REQUIRE(l[5] == 51);
+    expected = 20;
+    for (auto it = l.rbegin(); it != l.rend(); ++it)
+    {
+        REQUIRE((*it).key == expected);
+        expected--;
+    }
+    const auto & constL = l;
+    REQUIRE(std::distance(constL.begin(), constL.end()) == 20);
+    REQUIRE((*--l.end()).key == 20);
+    UnrolledSortedList<unsigned, unsigned, 4>::const_iterator it = l.begin();
+    REQUIRE(it == l.cbegin());
+}
+
+TEST_CASE("UnrolledCopyMoveAndEquality", "[Unrolled]")
+{
+    UnrolledSortedList<unsigned, std::string, 4> l;
+    UnrolledSortedList<unsigned, std::string, 4> p;
+    REQUIRE(l == p);
+    for (unsigned i = 0; i < 30; i++)
+    {
+        l.insert(i, std::to_string(i));
+    }
+    // inserted in the opposite order, so the Blocks are split up differently
+    for (unsigned i = 30; i > 0; i--)
+    {
+        p.insert(i - 1, std::to_string(i - 1));
+    }
+    REQUIRE(l == p);
+    p[7] = "changed";
+    REQUIRE(!(l == p));
+
+    UnrolledSortedList<unsigned, std::string, 4> copy(l);
+    REQUIRE(copy == l);
+    copy.remove(0);
+    REQUIRE(l.contains(0));
+    copy = l;
+    REQUIRE(copy == l);
+
+    UnrolledSortedList<unsigned, std::string, 4> moved(std::move(copy));
+    REQUIRE(moved == l);
+    REQUIRE(copy.isEmpty());
+    copy = std::move(moved);
+    REQUIRE(copy == l);
+}
+
+TEST_CASE("UnrolledUsesCompare", "[Unrolled]")
+{
+    // in decreasing order, across enough Blocks to split and merge them
+    UnrolledSortedList<unsigned, unsigned, 4, std::greater<unsigned>> l;
+    std::map<unsigned, unsigned, std::greater<unsigned>> expected;
+    for (unsigned i = 0; i < 200; i++)
+    {
+        unsigned k = (i * 37) % 101;
+        REQUIRE(l.insert(k, i) == expected.emplace(k, i).second);
+    }
+    for (unsigned k = 0; k < 101; k += 3)
+    {
+        l.remove(k);
+        expected.erase(k);
+    }
+    REQUIRE(l.size() == expected.size());
+    REQUIRE(std::equal(l.begin(), l.end(), expected.begin(), expected.end(), [](const auto & e, const auto & pair)
+    {
+        return e.key == pair.first && e.value == pair.second;
+    }));
+    REQUIRE(l.front() == 100);
+    REQUIRE(l.getIndex(100) == 0);
+    REQUIRE(l.largestLessThan(50) == 52);
+    REQUIRE(l.smallestGreaterThan(50) == 49);
+
+    // a Compare with state, where keys with the same remainder are the same key
+    struct ByRemainder
+    {
+        unsigned divisor;
+        bool operator()(unsigned a, unsigned b) const { return a % divisor < b % divisor; }
+    };
+    UnrolledSortedList<unsigned, unsigned, 4, ByRemainder> p{ByRemainder{10}};
+    REQUIRE(p.insert(13, 13));
+    REQUIRE_FALSE(p.insert(3, 3));
+    REQUIRE(p[23] == 13);
+    UnrolledSortedList<unsigned, unsigned, 4, ByRemainder> assigned{ByRemainder{7}};
+    assigned = p;
+    REQUIRE(assigned.key_comp().divisor == 10);
+    REQUIRE(assigned.contains(33));
+}
+
+// a value that throws when it is moved while armed is set
+struct Fragile
+{
+    static inline bool armed = false;
+    unsigned n;
+
+    Fragile(unsigned n) : n(n) {}
+    Fragile(const Fragile & other) = default;
+    Fragile(Fragile && other) : n(other.n)
+    {
+        if (armed)
+        {
+            throw std::runtime_error("move failed");
+        }
+    }
+    Fragile & operator=(const Fragile & other) = default;
+    Fragile & operator=(Fragile && other) = default;
+};
+
+TEST_CASE("UnrolledFailedInsertLeavesNoEmptyBlock", "[Unrolled]")
+{
+    UnrolledSortedList<unsigned, Fragile, 4> l;
+    Fragile::armed = true;
+    REQUIRE_THROWS_AS( l.insert(1, Fragile(1)), std::runtime_error );
+    Fragile::armed = false;
+    REQUIRE(l.isEmpty());
+    REQUIRE(l.begin() == l.end());
+    REQUIRE_FALSE(l.contains(1));
+    REQUIRE_THROWS_AS( l.front(), KeyNotFoundException );
+    REQUIRE(l.insert(2, Fragile(2)));
+    REQUIRE(l.insert(1, Fragile(1)));
+    REQUIRE(l.getIndex(2) == 1);
+    REQUIRE(l[1].n == 1);
+}
+
+// a key that counts how many of it exist
+struct Live
+{
+    static inline int count = 0;
+    unsigned n;
+
+    Live(unsigned n) : n(n) { count++; }
+    Live(const Live & other) : n(other.n) { count++; }
+    Live(Live && other) noexcept : n(other.n) { count++; }
+    ~Live() { count--; }
+    Live & operator=(const Live & other) = default;
+    Live & operator=(Live && other) = default;
+    bool operator<(const Live & other) const { return n < other.n; }
+};
+
+TEST_CASE("UnrolledFailedInsertChangesNothing", "[Unrolled]")
+{
+    {
+        UnrolledSortedList<Live, Fragile, 4> l;
+        for (unsigned k : {10, 20, 30})
+        {
+            l.insert(k, Fragile(k));
+        }
+        // into the middle of a Block
+        Fragile::armed = true;
+        REQUIRE_THROWS_AS( l.insert(15, Fragile(15)), std::runtime_error );
+        Fragile::armed = false;
+        REQUIRE(l.size() == 3);
+        REQUIRE_FALSE(l.contains(15));
+        REQUIRE(l.insert(40, Fragile(40)));
+        // into a full Block, which is split first
+        Fragile::armed = true;
+        REQUIRE_THROWS_AS( l.insert(25, Fragile(25)), std::runtime_error );
+        Fragile::armed = false;
+        REQUIRE(l.size() == 4);
+        REQUIRE(l.insert(25, Fragile(25)));
+        unsigned expected[] = {10, 20, 25, 30, 40};
+        unsigned index = 0;
+        for (const auto & [k, v] : l)
+        {
+            REQUIRE(k.n == expected[index]);
+            REQUIRE(v.n == expected[index++]);
+        }
+        REQUIRE(index == 5);
+    }
+    REQUIRE(Live::count == 0);
+}
+
+// a value that counts how often it is copied
+struct Counted
+{
+    static inline unsigned copies = 0;
+    unsigned n;
+
+    Counted(unsigned n) : n(n) {}
+    Counted(const Counted & other) : n(other.n) { copies++; }
+    Counted & operator=(const Counted & other) { n = other.n; copies++; return *this; }
+    Counted(Counted && other) = default;
+    Counted & operator=(Counted && other) = default;
+};
+
+TEST_CASE("UnrolledDuplicateInsertCopiesNothing", "[Unrolled]")
+{
+    UnrolledSortedList<std::string, Counted, 4> l;
+    const std::string key = "a key long enough not to fit in a small string";
+    const Counted value(1);
+    for (unsigned i = 0; i < 10; i++)
+    {
+        l.insert(std::to_string(i), value);
+    }
+    Counted::copies = 0;
+    REQUIRE_FALSE(l.insert("5", value));
+    REQUIRE(Counted::copies == 0);
+    REQUIRE(l.insert(key, value));
+    REQUIRE(Counted::copies == 1);
+    REQUIRE_FALSE(l.insert(key, Counted(2)));
+    REQUIRE(l[key].n == 1);
+    REQUIRE(l.size() == 11);
+}
+
+TEST_CASE("UnrolledPreIncrement", "[Unrolled]")
+{
+    UnrolledSortedList<std::string, unsigned> numbers;
+    numbers.insert("Jenny", 8675309);
+    ++numbers;
+    REQUIRE(numbers["Jenny"] == 8675310);
+}
+
+} // end namespace